@@ -162,6 +162,10 @@
 #   (the new default is true, so this keeps behavior the same for 
 #   existing users)
 
+# Incremented to format 37, by lasgouttes
+#   Add \undo_memory_limit.
+#   No conversion necessary.
+
 # NOTE: The format should also be updated in LYXRC.cpp and
 # in configure.py (search for lyxrc_fileformat).
 
@@ -542,5 +546,6 @@ conversions = [
 	[ 33, []],
 	[ 34, [rename_cyrillic_kmap_files]],
 	[ 35, [add_dark_color]],
-	[ 36, [add_spellcheck_default]]
+	[ 36, [add_spellcheck_default]],
+	[ 37, []]
 ]
@@ -13,6 +13,7 @@
 
 #include "AspellChecker.h"
 #include "PersonalWordList.h"
+#include "SpellResultCache.h"
 
 #include "LyXRC.h"
 #include "WordLangTuple.h"
@@ -90,6 +91,9 @@ struct AspellChecker::Private
 
 	LangPersonalWordList personal_;
 
+	/// results of previous dictionary lookups
+	SpellResultCache cache_;
+
 	/// the location below system/user directory
 	/// there the rws files lookup will happen
 	const string dictDirectory(void)
@@ -447,8 +451,14 @@ SpellChecker::Result AspellChecker::check(WordLangTuple const & word,
 		if (it->word() == word.word())
 			return DOCUMENT_LEARNED_WORD;
 	}
-	SpellChecker::Result rc = d->check(m, word);
-	return (rc == WORD_OK && d->learned(word)) ? LEARNED_WORD : rc;
+	SpellChecker::Result rc;
+	if (d->cache_.result(word, changeNumber(), rc))
+		return rc;
+	rc = d->check(m, word);
+	if (rc == WORD_OK && d->learned(word))
+		rc = LEARNED_WORD;
+	d->cache_.setResult(word, changeNumber(), rc);
+	return rc;
 }
 
 
@@ -485,6 +495,9 @@ void AspellChecker::suggest(WordLangTuple const & wl,
 	if (!m)
 		return;
 
+	if (d->cache_.suggestions(wl, changeNumber(), suggestions))
+		return;
+
 	string const word = d->toAspellWord(wl.word());
 	AspellWordList const * sugs =
 		aspell_speller_suggest(m, word.c_str(), -1);
@@ -501,6 +514,7 @@ void AspellChecker::suggest(WordLangTuple const & wl,
 	}
 
 	delete_aspell_string_enumeration(els);
+	d->cache_.setSuggestions(wl, changeNumber(), suggestions);
 }
 
 
@@ -0,0 +1,214 @@
+/**
+ * \file Benchmark.cpp
+ * This file is part of LyX, the document processor.
+ * Licence details can be found in the file COPYING.
+ *
+ * Full author contact details are available in file CREDITS.
+ */
+
+#include <config.h>
+
+#include "Benchmark.h"
+
+#include "FuncCode.h"
+#include "FuncRequest.h"
+#include "LyX.h"
+#include "LyXAction.h"
+
+#include "support/convert.h"
+#include "support/debug.h"
+#include "support/FileName.h"
+#include "support/lstrings.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace lyx::support;
+
+namespace lyx {
+
+namespace {
+
+/// One line of the script
+struct Step {
+	Step(string const & n, FuncRequest const & f, int c)
+		: name(n), func(f), count(c) {}
+	/// the name of the function, used to group the results
+	string name;
+	///
+	FuncRequest func;
+	/// how often the function is dispatched in a row
+	int count;
+};
+
+
+/// The measurements of all dispatches of one function
+struct Samples {
+	Samples() : allocations(0) {}
+	/// in microseconds
+	vector<double> times;
+	///
+	unsigned long long allocations;
+};
+
+
+/// \returns the \p p-th percentile of the sorted \p times (nearest rank)
+double percentile(vector<double> const & times, double p)
+{
+	size_t rank = size_t(p * times.size() + 0.999999);
+	rank = max(rank, size_t(1));
+	return times[min(rank, times.size()) - 1];
+}
+
+
+Benchmark * current_benchmark = nullptr;
+
+} // namespace
+
+
+struct Benchmark::Private
+{
+	Private(FileName const & script, int repeat, AllocationCounter counter)
+		: script_(script), repeat_(repeat), counter_(counter)
+	{}
+
+	///
+	FileName const script_;
+	///
+	int const repeat_;
+	///
+	AllocationCounter const counter_;
+	///
+	vector<Step> steps_;
+	///
+	map<string, Samples> samples_;
+};
+
+
+Benchmark::Benchmark(FileName const & script, int repeat,
+                     AllocationCounter counter)
+	: d(new Private(script, repeat, counter))
+{}
+
+
+Benchmark::~Benchmark()
+{
+	delete d;
+}
+
+
+bool Benchmark::read()
+{
+	ifstream ifs(d->script_.toFilesystemEncoding().c_str());
+	if (!ifs) {
+		LYXERR0("Cannot read benchmark script " << d->script_.absFileName());
+		return false;
+	}
+
+	d->steps_.clear();
+	string line;
+	int line_no = 0;
+	while (getline(ifs, line)) {
+		++line_no;
+		line = trim(line);
+		if (line.empty() || line[0] == '#')
+			continue;
+		int count = 1;
+		string command = line;
+		string first;
+		string const rest = split(line, first, ' ');
+		if (isStrInt(first)) {
+			count = convert<int>(first);
+			command = trim(rest);
+		}
+		FuncRequest const func = lyxaction.lookupFunc(command);
+		if (func.action() == LFUN_UNKNOWN_ACTION || count < 1) {
+			LYXERR0(d->script_.absFileName() << ':' << line_no
+				<< ": invalid benchmark step `" << line << '\'');
+			return false;
+		}
+		string name;
+		split(command, name, ' ');
+		d->steps_.push_back(Step(name, func, count));
+	}
+	return true;
+}
+
+
+void Benchmark::run()
+{
+	typedef chrono::steady_clock clock;
+	for (int i = 0; i < d->repeat_; ++i) {
+		for (Step const & step : d->steps_) {
+			Samples & samples = d->samples_[step.name];
+			for (int j = 0; j < step.count; ++j) {
+				unsigned long long const allocs =
+					d->counter_ ? d->counter_() : 0;
+				clock::time_point const start = clock::now();
+				lyx::dispatch(step.func);
+				chrono::duration<double, micro> const elapsed =
+					clock::now() - start;
+				samples.times.push_back(elapsed.count());
+				if (d->counter_)
+					samples.allocations += d->counter_() - allocs;
+			}
+		}
+	}
+}
+
+
+void Benchmark::report(ostream & os) const
+{
+	os << left << setw(24) << "function" << right
+	   << setw(8) << "count"
+	   << setw(10) << "mean"
+	   << setw(10) << "p50"
+	   << setw(10) << "p90"
+	   << setw(10) << "p99"
+	   << setw(10) << "max"
+	   << setw(10) << "allocs" << '\n';
+	os << fixed << setprecision(1);
+	for (auto const & entry : d->samples_) {
+		vector<double> times = entry.second.times;
+		if (times.empty())
+			continue;
+		sort(times.begin(), times.end());
+		double sum = 0;
+		for (double t : times)
+			sum += t;
+		os << left << setw(24) << entry.first << right
+		   << setw(8) << times.size()
+		   << setw(10) << sum / times.size()
+		   << setw(10) << percentile(times, 0.5)
+		   << setw(10) << percentile(times, 0.9)
+		   << setw(10) << percentile(times, 0.99)
+		   << setw(10) << times.back();
+		if (d->counter_)
+			os << setw(10) << double(entry.second.allocations) / times.size();
+		else
+			os << setw(10) << '-';
+		os << '\n';
+	}
+	os << "(times in microseconds, allocations per call)" << endl;
+}
+
+
+Benchmark * theBenchmark()
+{
+	return current_benchmark;
+}
+
+
+void setBenchmark(Benchmark * bench)
+{
+	current_benchmark = bench;
+}
+
+
+} // namespace lyx
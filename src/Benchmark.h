@@ -0,0 +1,73 @@
+// -*- C++ -*-
+/**
+ * \file Benchmark.h
+ * This file is part of LyX, the document processor.
+ * Licence details can be found in the file COPYING.
+ *
+ * Full author contact details are available in file CREDITS.
+ */
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <iosfwd>
+
+
+namespace lyx {
+
+namespace support { class FileName; }
+
+/**
+ * Replays a script of LyX functions in the current view and measures how
+ * long each of them takes. This is used by the lyx-bench program (see
+ * development/benchmarks/README).
+ *
+ * A script contains one function per line, as given to the minibuffer,
+ * optionally preceded by a repetition count:
+ * \code
+ * # type a sentence 20 times
+ * 20 self-insert The quick brown fox jumps over the lazy dog.
+ * paragraph-break
+ * \endcode
+ * Empty lines and lines starting with '#' are ignored.
+ *
+ * The measured time of a function includes the metrics update of the
+ * view, but not the painting, which is done later by the event loop.
+ */
+class Benchmark {
+public:
+	/// Returns the number of memory allocations done so far
+	typedef unsigned long long (*AllocationCounter)();
+
+	/// The script is replayed \p repeat times
+	explicit Benchmark(support::FileName const & script, int repeat = 1,
+	                   AllocationCounter counter = nullptr);
+	///
+	~Benchmark();
+
+	/// Read the script. \returns false if it cannot be read.
+	bool read();
+	/// Dispatch the functions of the script
+	void run();
+	/// Print the latency percentiles and allocations per function
+	void report(std::ostream & os) const;
+
+private:
+	/// noncopyable
+	Benchmark(Benchmark const &);
+	void operator=(Benchmark const &);
+
+	struct Private;
+	Private * d;
+};
+
+
+/// The benchmark to run once the documents are loaded, if any
+Benchmark * theBenchmark();
+///
+void setBenchmark(Benchmark * bench);
+
+
+} // namespace lyx
+
+#endif // BENCHMARK_H
@@ -326,16 +326,61 @@ bool multipleAuthors(docstring const & author)
 
 // converts a string containing LaTeX commands into unicode
 // for display.
+bool isWordCharASCII(char_type c)
+{
+	return isAlnumASCII(c) || c == '_';
+}
+
+
+// \return the end of the LaTeX command that starts at \p pos in \p str,
+// including a star and the arguments in braces that may belong to it
+// (e.g. \"{\i}). Arguments containing spaces are left out, since they
+// are not part of any symbol.
+size_t commandEnd(docstring const & str, size_t const pos)
+{
+	size_t const len = str.size();
+	size_t end = pos + 1;
+	if (end < len && isAlphaASCII(str[end])) {
+		while (end < len && isAlphaASCII(str[end]))
+			++end;
+	} else if (end < len)
+		++end;
+	if (end < len && str[end] == '*')
+		++end;
+	while (end < len && str[end] == '{') {
+		int depth = 0;
+		size_t k = end;
+		for (; k < len; ++k) {
+			if (str[k] == '{')
+				++depth;
+			else if (str[k] == '}' && --depth == 0)
+				break;
+			else if (isSpace(str[k]))
+				return end;
+		}
+		if (k == len)
+			return end;
+		end = k + 1;
+	}
+	return end;
+}
+
+
 docstring convertLaTeXCommands(docstring const & str)
 {
+	// We walk through val with pos instead of cutting off the
+	// characters we have consumed, so that this is linear in the
+	// length of the string.
 	docstring val = str;
+	size_t pos = 0;
 	docstring ret;
+	ret.reserve(str.size());
 
 	bool scanning_cmd = false;
 	bool scanning_math = false;
 	bool escaped = false; // used to catch \$, etc.
-	while (!val.empty()) {
-		char_type const ch = val[0];
+	while (pos < val.size()) {
+		char_type const ch = val[pos];
 
 		// if we're scanning math, we output everything until we
 		// find an unescaped $, at which point we break out.
@@ -347,7 +392,7 @@ docstring convertLaTeXCommands(docstring const & str)
 			else if (ch == '$')
 				scanning_math = false;
 			ret += ch;
-			val = val.substr(1);
+			++pos;
 			continue;
 		}
 
@@ -356,7 +401,7 @@ docstring convertLaTeXCommands(docstring const & str)
 		// isn't alpha.
 		if (scanning_cmd) {
 			if (isAlphaASCII(ch)) {
-				val = val.substr(1);
+				++pos;
 				escaped = false;
 				continue;
 			}
@@ -373,14 +418,14 @@ docstring convertLaTeXCommands(docstring const & str)
 				ret.push_back(0x2009);
 			else
 				ret += ch;
-			val = val.substr(1);
+			++pos;
 			escaped = false;
 			continue;
 		}
 
 		if (ch == '$') {
 			ret += ch;
-			val = val.substr(1);
+			++pos;
 			scanning_math = true;
 			continue;
 		}
@@ -389,16 +434,19 @@ docstring convertLaTeXCommands(docstring const & str)
 		// {\v a} to \v{a} (see #9340).
 		// FIXME: This is a sort of mini-tex2lyx.
 		//        Use the real tex2lyx instead!
-		static regex const tma_reg("^\\{\\\\[bcCdfGhHkrtuUv]\\s\\w\\}");
-		if (regex_search(to_utf8(val), tma_reg)) {
-			val = val.substr(1);
-			val.replace(2, 1, from_ascii("{"));
+		static docstring const tma_cmds = from_ascii("bcCdfGhHkrtuUv");
+		if (ch == '{' && pos + 5 < val.size() && val[pos + 1] == '\\'
+		    && tma_cmds.find(val[pos + 2]) != docstring::npos
+		    && isASCII(val[pos + 3]) && isSpace(val[pos + 3])
+		    && isWordCharASCII(val[pos + 4]) && val[pos + 5] == '}') {
+			val[pos + 3] = '{';
+			++pos;
 			continue;
 		}
 
 		// Apart from the above, we just ignore braces
 		if (ch == '{' || ch == '}') {
-			val = val.substr(1);
+			++pos;
 			continue;
 		}
 
@@ -406,7 +454,7 @@ docstring convertLaTeXCommands(docstring const & str)
 		// this doesn't, just output it.
 		if (ch != '\\') {
 			ret += ch;
-			val = val.substr(1);
+			++pos;
 			continue;
 		}
 
@@ -415,27 +463,51 @@ docstring convertLaTeXCommands(docstring const & str)
 		// unicodesymbols has things in the form: \"{u},
 		// whereas we may see things like: \"u. So we'll
 		// look for that and change it, if necessary.
+		// Only the command itself is handed to fromLaTeXCommand(),
+		// which would otherwise look at the whole rest of the string.
 		// FIXME: This is a sort of mini-tex2lyx.
 		//        Use the real tex2lyx instead!
-		static regex const reg("^\\\\\\W\\w");
-		if (regex_search(to_utf8(val), reg)) {
-			val.insert(3, from_ascii("}"));
-			val.insert(2, from_ascii("{"));
+		size_t end;
+		docstring cmd;
+		bool const braced = pos + 2 < val.size() && isASCII(val[pos + 1])
+			&& !isWordCharASCII(val[pos + 1]) && isWordCharASCII(val[pos + 2]);
+		if (braced) {
+			end = pos + 3;
+			cmd = val.substr(pos, 2) + '{' + val[pos + 2] + '}';
+		} else {
+			end = commandEnd(val, pos);
+			cmd = val.substr(pos, end - pos);
 		}
 		bool termination;
 		docstring rem;
-		docstring const cnvtd = Encodings::fromLaTeXCommand(val,
+		docstring const cnvtd = Encodings::fromLaTeXCommand(cmd,
 				Encodings::TEXT_CMD, termination, rem);
 		if (!cnvtd.empty()) {
 			// it did, so we'll take that bit and proceed with what's left
 			ret += cnvtd;
-			val = rem;
+			if (rem.empty()) {
+				pos = end;
+				// LaTeX swallows the termination of the command
+				if (termination) {
+					if (val.compare(pos, 2, from_ascii("{}")) == 0)
+						pos += 2;
+					else
+						while (pos < val.size() && val[pos] == ' ')
+							++pos;
+				}
+			} else if (braced) {
+				ret += convertLaTeXCommands(rem);
+				pos = end;
+			} else {
+				// rem is what is left of cmd
+				pos = end - rem.size();
+			}
 			continue;
 		}
 		// it's a command of some sort
 		scanning_cmd = true;
 		escaped = true;
-		val = val.substr(1);
+		++pos;
 	}
 	return ret;
 }
@@ -444,22 +516,23 @@ docstring convertLaTeXCommands(docstring const & str)
 // Escape '<' and '>' and remove richtext markers (e.g. {!this is richtext!}) from a string.
 docstring processRichtext(docstring const & str, bool richtext)
 {
-	docstring val = str;
 	docstring ret;
+	ret.reserve(str.size());
 
 	bool scanning_rich = false;
-	while (!val.empty()) {
-		char_type const ch = val[0];
-		if (ch == '{' && val.size() > 1 && val[1] == '!') {
+	size_t const len = str.size();
+	for (size_t pos = 0; pos < len; ++pos) {
+		char_type const ch = str[pos];
+		if (ch == '{' && pos + 1 < len && str[pos + 1] == '!') {
 			// beginning of rich text
 			scanning_rich = true;
-			val = val.substr(2);
+			++pos;
 			continue;
 		}
-		if (scanning_rich && ch == '!' && val.size() > 1 && val[1] == '}') {
+		if (scanning_rich && ch == '!' && pos + 1 < len && str[pos + 1] == '}') {
 			// end of rich text
 			scanning_rich = false;
-			val = val.substr(2);
+			++pos;
 			continue;
 		}
 		if (richtext) {
@@ -478,7 +551,6 @@ docstring processRichtext(docstring const & str, bool richtext)
 			ret += ch;
 		// else the character is discarded, which will happen only if
 		// richtext == false and we are scanning rich text
-		val = val.substr(1);
 	}
 	return ret;
 }
@@ -1018,34 +1090,33 @@ docstring const & BibTeXInfo::getInfo(BibTeXInfoList const & xrefs,
 		format_ = format;
 	}
 
-	if (!richtext && !info_.empty()) {
-		info_ = convertLaTeXCommands(processRichtext(info_, false));
+	if (!richtext && !info_.empty())
 		return info_;
-	}
 	if (richtext && !info_richtext_.empty())
 		return info_richtext_;
 
 	if (!is_bibtex_) {
 		BibTeXInfo::const_iterator it = find(from_ascii("ref"));
-		info_ = it->second;
+		info_ = convertLaTeXCommands(processRichtext(it->second, false));
 		return info_;
 	}
 
 	int counter = 0;
-	info_ = expandFormat(format, xrefs, counter, buf,
+	// Do not store this in info_, the cached plain text info
+	docstring const expanded = expandFormat(format, xrefs, counter, buf,
 		ci, false, false);
 
-	if (info_.empty()) {
+	if (expanded.empty()) {
 		// this probably shouldn't happen
-		return info_;
+		return richtext ? info_richtext_ : info_;
 	}
 
 	if (richtext) {
-		info_richtext_ = convertLaTeXCommands(processRichtext(info_, true));
+		info_richtext_ = convertLaTeXCommands(processRichtext(expanded, true));
 		return info_richtext_;
 	}
 
-	info_ = convertLaTeXCommands(processRichtext(info_, false));
+	info_ = convertLaTeXCommands(processRichtext(expanded, false));
 	return info_;
 }
 
@@ -1068,6 +1139,19 @@ docstring const BibTeXInfo::getLabel(BibTeXInfoList const & xrefs,
 }
 
 
+bool BibTeXInfo::hasSameData(BibTeXInfo const & other) const
+{
+	return is_bibtex_ == other.is_bibtex_
+		&& bib_key_ == other.bib_key_
+		&& label_ == other.label_
+		&& all_data_ == other.all_data_
+		&& entry_type_ == other.entry_type_
+		&& cite_number_ == other.cite_number_
+		&& modifier_ == other.modifier_
+		&& bimap_ == other.bimap_;
+}
+
+
 docstring const & BibTeXInfo::operator[](docstring const & field) const
 {
 	BibTeXInfo::const_iterator it = find(field);
@@ -1642,6 +1726,57 @@ void BiblioInfo::makeCitationLabels(Buffer const & buf)
 }
 
 
+set<docstring> const BiblioInfo::changedKeys(BiblioInfo const & old) const
+{
+	set<docstring> changed;
+	for (auto const & bi : bimap_) {
+		const_iterator const it = old.find(bi.first);
+		if (it == old.end() || !bi.second.hasSameData(it->second))
+			changed.insert(bi.first);
+	}
+	for (auto const & bi : old.bimap_) {
+		if (find(bi.first) == end())
+			changed.insert(bi.first);
+	}
+	if (changed.empty())
+		return changed;
+
+	// The entries that get data from a changed entry have changed, too.
+	for (auto const & bi : bimap_) {
+		if (changed.find(bi.first) != changed.end())
+			continue;
+		for (docstring const & xref : getXRefs(bi.second)) {
+			if (changed.find(xref) != changed.end()) {
+				changed.insert(bi.first);
+				break;
+			}
+		}
+	}
+
+	// Entries with the same authors and year are told apart by a modifier
+	// (1998a, 1998b) in makeCitationLabels(), so adding, removing or
+	// changing one of them can change the labels of the others.
+	auto group = [](BiblioInfo const & bi, BibTeXInfo const & entry) {
+		return entry.getAuthorOrEditorList() + '\n' + bi.getYear(entry.key());
+	};
+	set<docstring> groups;
+	for (docstring const & key : changed) {
+		const_iterator const it = find(key);
+		if (it != end())
+			groups.insert(group(*this, it->second));
+		const_iterator const oit = old.find(key);
+		if (oit != old.end())
+			groups.insert(group(old, oit->second));
+	}
+	for (auto const & bi : bimap_) {
+		if (changed.find(bi.first) == changed.end()
+		    && groups.find(group(*this, bi.second)) != groups.end())
+			changed.insert(bi.first);
+	}
+	return changed;
+}
+
+
 //////////////////////////////////////////////////////////////////////
 //
 // CitationStyle
@@ -125,6 +125,8 @@ public:
 	docstring entryType() const { return entry_type_; }
 	///
 	bool isBibTeX() const { return is_bibtex_; }
+	/// Does \p other hold the same entry? The caches are not compared.
+	bool hasSameData(BibTeXInfo const & other) const;
 private:
 	/// like operator[], except, if the field is empty, it will attempt
 	/// to get the data from xref BibTeXInfo objects, which would normally
@@ -259,6 +261,10 @@ public:
 		{ return cited_entries_; }
 	///
 	void makeCitationLabels(Buffer const & buf);
+	/// \return the keys whose entries differ between \p old and this,
+	/// including the entries that refer to these via crossref or xdata
+	/// and the entries whose year modifier may change with them.
+	std::set<docstring> const changedKeys(BiblioInfo const & old) const;
 	///
 	const_iterator begin() const { return bimap_.begin(); }
 	///
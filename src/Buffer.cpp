@@ -23,6 +23,7 @@
 #include "Chktex.h"
 #include "ColorSet.h"
 #include "Converter.h"
+#include "ConverterCache.h"
 #include "Counters.h"
 #include "Cursor.h"
 #include "CutAndPaste.h"
@@ -85,6 +86,7 @@
 #include "frontends/WorkAreaManager.h"
 
 #include "support/lassert.h"
+#include "support/checksum.h"
 #include "support/convert.h"
 #include "support/debug.h"
 #include "support/docstring_list.h"
@@ -105,8 +107,12 @@
 #include "support/textutils.h"
 #include "support/types.h"
 
+#include <QRunnable>
+#include <QThreadPool>
+
 #include <algorithm>
 #include <fstream>
+#include <future>
 #include <iomanip>
 #include <map>
 #include <memory>
@@ -149,6 +155,151 @@ typedef map<docstring, Buffer::References> RefCache;
 typedef list<CloneList_ptr> CloneStore;
 CloneStore cloned_buffers;
 
+
+/// Read the format from the "\lyxformat" line of a LyX file.
+/// Returns -1 if there is none.
+int readLyXFormat(Lexer & lex)
+{
+	if (!lex.checkFor("\\lyxformat"))
+		return -1;
+
+	string tmp_format;
+	lex >> tmp_format;
+
+	// LyX formats 217 and earlier were written as 2.17. This corresponds
+	// to files from LyX versions < 1.1.6.3. We just remove the dot in
+	// these cases. See also: www.lyx.org/trac/changeset/1313.
+	size_t dot = tmp_format.find_first_of(".,");
+	if (dot != string::npos)
+		tmp_format.erase(dot, 1);
+
+	return convert<int>(tmp_format);
+}
+
+
+/// Convert \p infile to the current format in \p outfile with the
+/// lyx2lyx script \p lyx2lyx.
+bool runLyX2LyX(string const & python, FileName const & lyx2lyx,
+	FileName const & infile, FileName const & outfile)
+{
+	// The result of lyx2lyx only depends on the contents of the file, on
+	// the target format and on lyx2lyx itself, so reopening an old
+	// document does not have to convert it again. The LyX version and
+	// the location of lyx2lyx identify the latter.
+	string const cache_format = "lyx" + convert<string>(LYX_FORMAT) + '-'
+		+ convert<string>(checksum(string(lyx_version) + ' '
+		                           + lyx2lyx.absFileName()));
+	ConverterCache const & cache = ConverterCache::get();
+	if (cache.inCache(infile, cache_format)
+	    && cache.copy(infile, cache_format, outfile)) {
+		LYXERR(Debug::INFO, "Using cached conversion of " << infile);
+		return true;
+	}
+
+	// Run lyx2lyx:
+	//   $python$ "$lyx2lyx$" -t $LYX_FORMAT$ -o "$tempfile$" "$filetoread$"
+	ostringstream command;
+	command << python
+		<< ' ' << quoteName(lyx2lyx.toFilesystemEncoding())
+		<< " -t " << convert<string>(LYX_FORMAT)
+		<< " -o " << quoteName(outfile.toSafeFilesystemEncoding())
+		<< ' ' << quoteName(infile.toSafeFilesystemEncoding());
+	string const command_str = command.str();
+
+	LYXERR(Debug::INFO, "Running '" << command_str << '\'');
+
+	cmd_ret const ret = runCommand(command_str);
+	if (!ret.valid)
+		return false;
+	// Do not replay a failed conversion
+	if (ret.success && !outfile.isFileEmpty())
+		cache.add(infile, cache_format, outfile);
+	return true;
+}
+
+
+/// The contents of a child document, read and converted to the current
+/// format in a worker thread while the master document is loaded.
+struct PreparedChild {
+	/// the format of the file on disk
+	int file_format = -1;
+	/// the decompressed contents in the current format,
+	/// empty if something went wrong
+	string contents;
+};
+
+
+/// Read \p fn into memory, converting it with lyx2lyx if needed.
+/// This runs in a worker thread: errors are not reported, the document
+/// is just read again in the main thread if this fails.
+PreparedChild prepareChild(FileName const & fn, string const & python,
+	FileName const & lyx2lyx)
+{
+	PreparedChild prepared;
+	string contents;
+	{
+		gz::igzstream ifs(fn.toFilesystemEncoding().c_str());
+		if (!ifs)
+			return prepared;
+		ostringstream oss;
+		oss << ifs.rdbuf();
+		contents = oss.str();
+	}
+	// Skip byte order mark.
+	if (prefixIs(contents, "\xef\xbb\xbf"))
+		contents.erase(0, 3);
+
+	istringstream is(contents);
+	Lexer lex;
+	lex.setStream(is);
+	prepared.file_format = readLyXFormat(lex);
+	if (prepared.file_format == -1)
+		return prepared;
+
+	if (prepared.file_format == LYX_FORMAT) {
+		prepared.contents = move(contents);
+		return prepared;
+	}
+
+	if (lyx2lyx.empty())
+		return prepared;
+	TempFile tempfile("Buffer_convertLyXFormatXXXXXX.lyx");
+	FileName const tmpfile = tempfile.name();
+	if (tmpfile.empty() || !runLyX2LyX(python, lyx2lyx, fn, tmpfile))
+		return prepared;
+	ifstream ifs(tmpfile.toFilesystemEncoding().c_str());
+	ostringstream oss;
+	oss << ifs.rdbuf();
+	prepared.contents = oss.str();
+	return prepared;
+}
+
+
+class PrepareChildTask : public QRunnable
+{
+public:
+	PrepareChildTask(FileName const & fn, string const & python,
+	                 FileName const & lyx2lyx)
+		: fn_(fn), python_(python), lyx2lyx_(lyx2lyx)
+	{}
+	///
+	void run() override
+	{
+		promise_.set_value(prepareChild(fn_, python_, lyx2lyx_));
+	}
+	///
+	future<PreparedChild> result() { return promise_.get_future(); }
+private:
+	///
+	FileName const fn_;
+	///
+	string const python_;
+	///
+	FileName const lyx2lyx_;
+	///
+	promise<PreparedChild> promise_;
+};
+
 } // namespace
 
 
@@ -175,6 +326,19 @@ public:
 	/// Update macro table starting with position of it \param it in some
 	/// text inset.
 	void updateMacros(DocIterator & it, DocIterator & scope);
+	/// Check that the insets relevant for the macro tables, starting
+	/// with position \param it up to paragraph \param lastpit, are
+	/// still the ones recorded by the last run of updateMacros, at the
+	/// same positions. \param idx is the index of the next anchor to
+	/// compare.
+	bool sameMacroAnchors(DocIterator & it, pit_type lastpit,
+		size_t & idx) const;
+	/// Compare the inset at \param it with anchor number \param idx
+	bool sameMacroAnchor(DocIterator const & it, Inset const * inset,
+		docstring const & name, size_t & idx) const;
+	/// Check that the paragraphs changed since the last run of
+	/// updateMacros neither contain nor move any macro anchor.
+	bool macroChangeKeepsAnchors() const;
 	///
 	void setLabel(ParIterator & it, UpdateType utype) const;
 
@@ -228,6 +392,41 @@ public:
 	/// map from children inclusion positions to their scope and their buffer
 	PositionScopeBufferMap position_to_children;
 
+	/// An inset the macro tables depend on: a macro template, an
+	/// included child or a text inset opening a new macro scope.
+	struct MacroAnchor {
+		MacroAnchor(DocIterator const & p, Inset const * i,
+			    docstring const & n)
+			: pos(p), inset(i), name(n) {}
+		DocIterator pos;
+		Inset const * inset;
+		/// name of the macro template
+		docstring name;
+	};
+	/// all macro anchors in document order, as found by updateMacros
+	vector<MacroAnchor> macro_anchors;
+	/// number of the last top level paragraph at the time of updateMacros
+	pit_type macro_lastpit = 0;
+	/// do the macro tables still correspond to macro_anchors?
+	mutable bool macro_anchors_valid = false;
+	/// The paragraphs changed since the last run of updateMacros are
+	/// those from macro_change_from to lastpit - macro_change_end of
+	/// this cell. It is empty if nothing has been changed.
+	DocIterator macro_change_cell;
+	///
+	pit_type macro_change_from = 0;
+	///
+	pit_type macro_change_end = 0;
+	/// have paragraphs of more than one cell been changed?
+	bool macro_changes_scattered = false;
+
+	/// Start reading the children of this buffer in worker threads
+	void prepareChildren();
+	/// Get the contents of child \p fn, if prepareChildren() has read it
+	bool takePreparedChild(FileName const & fn, PreparedChild & prepared) const;
+	/// The children being read by prepareChildren()
+	mutable map<FileName, future<PreparedChild>> prepared_children;
+
 	/// Contains the old buffer filePath() while saving-as, or the
 	/// directory where the document was last saved while loading.
 	string old_position;
@@ -314,6 +513,30 @@ public:
 	/// we ran updateBuffer(), i.e., whether citation labels may need
 	/// to be updated.
 	mutable bool cite_labels_valid_;
+	/// If the citation labels are not valid only because bibliography
+	/// entries have changed, only the citations of these entries need
+	/// new labels. Their keys are collected in changed_cite_keys_ when
+	/// the bibinfo cache is reloaded.
+	mutable bool cite_labels_partly_valid_;
+	///
+	mutable set<docstring> changed_cite_keys_;
+	/// The bibliography entries may change. Only the citations of the
+	/// changed entries will need new labels.
+	void invalidateChangedCiteLabels() const
+	{
+		if (cite_labels_valid_) {
+			cite_labels_partly_valid_ = true;
+			changed_cite_keys_.clear();
+		}
+		cite_labels_valid_ = false;
+	}
+	///
+	void setCiteLabelsValid() const
+	{
+		cite_labels_valid_ = true;
+		cite_labels_partly_valid_ = false;
+		changed_cite_keys_.clear();
+	}
 	/// Do we have a bibliography environment?
 	mutable bool have_bibitems_;
 
@@ -342,6 +565,13 @@ public:
 	/// we need to back it up still?
 	bool need_format_backup;
 
+	/// Has the buffer not changed since markSaveSnapshot()?
+	bool save_snapshot_current = false;
+	/// Is the file being written between markSaveSnapshot() and saveDone()?
+	bool save_in_progress = false;
+	/// Did the file monitor fire while the file was being written?
+	bool notified_during_save = false;
+
 	/// Ignore the parent (e.g. when exporting a child standalone)?
 	bool ignore_parent;
 
@@ -459,7 +689,7 @@ Buffer::Impl::Impl(Buffer * owner, FileName const & file, bool readonly_,
 	  preview_loader_(nullptr), cloned_buffer_(cloned_buffer),
 	  clone_list_(nullptr), parent_buffer(nullptr), file_format(LYX_FORMAT),
 	  doing_export(false), require_fresh_start_(false), cite_labels_valid_(false),
-	  have_bibitems_(false), lyx_clean(true), bak_clean(true), unnamed(false),
+	  cite_labels_partly_valid_(false), have_bibitems_(false), lyx_clean(true), bak_clean(true), unnamed(false),
 	  internal_buffer(false), read_only(readonly_), file_fully_loaded(false),
 	  need_format_backup(false), ignore_parent(false), macro_lock(false),
 	  externally_modified_(false), bibinfo_cache_valid_(false),
@@ -486,6 +716,8 @@ Buffer::Impl::Impl(Buffer * owner, FileName const & file, bool readonly_,
 	bibinfo_cache_valid_ = cloned_buffer_->d->bibinfo_cache_valid_;
 	bibfile_status_ = cloned_buffer_->d->bibfile_status_;
 	cite_labels_valid_ = cloned_buffer_->d->cite_labels_valid_;
+	cite_labels_partly_valid_ = cloned_buffer_->d->cite_labels_partly_valid_;
+	changed_cite_keys_ = cloned_buffer_->d->changed_cite_keys_;
 	have_bibitems_ = cloned_buffer_->d->have_bibitems_;
 	unnamed = cloned_buffer_->d->unnamed;
 	internal_buffer = cloned_buffer_->d->internal_buffer;
@@ -805,6 +1037,7 @@ Undo & Buffer::undo()
 void Buffer::setChild(DocIterator const & dit, Buffer * child)
 {
 	d->children_positions[child] = dit;
+	d->macro_anchors_valid = false;
 }
 
 
@@ -1185,8 +1418,68 @@ bool Buffer::readString(string const & s)
 }
 
 
+void Buffer::Impl::prepareChildren()
+{
+	if (cloned_buffer_ || internal_buffer)
+		return;
+
+	// The same child can be included several times
+	set<FileName> children;
+	InsetIterator it = begin(*inset);
+	InsetIterator const itend = end(*inset);
+	for (; it != itend; ++it) {
+		if (it->lyxCode() != INCLUDE_CODE)
+			continue;
+		FileName const fn =
+			static_cast<InsetInclude const &>(*it).childFileToLoad();
+		if (!fn.empty() && !prepared_children.count(fn))
+			children.insert(fn);
+	}
+	if (children.size() < 2)
+		return;
+
+	LYXERR(Debug::FILES, "Reading " << children.size()
+	       << " child documents in worker threads");
+	string const python = os::python();
+	FileName const lyx2lyx = libFileSearch("lyx2lyx", "lyx2lyx");
+	for (FileName const & fn : children) {
+		PrepareChildTask * task = new PrepareChildTask(fn, python, lyx2lyx);
+		prepared_children[fn] = task->result();
+		// the thread pool takes ownership of the task
+		QThreadPool::globalInstance()->start(task);
+	}
+}
+
+
+bool Buffer::Impl::takePreparedChild(FileName const & fn,
+	PreparedChild & prepared) const
+{
+	auto it = prepared_children.find(fn);
+	if (it == prepared_children.end())
+		return false;
+	prepared = it->second.get();
+	prepared_children.erase(it);
+	return !prepared.contents.empty();
+}
+
+
 Buffer::ReadStatus Buffer::readFile(FileName const & fn)
 {
+	// The file may have been read and converted already, in a
+	// separate thread, while the parent document was loaded.
+	PreparedChild prepared;
+	if (d->parent() && d->parent()->d->takePreparedChild(fn, prepared)) {
+		istringstream is(prepared.contents);
+		Lexer lex;
+		lex.setStream(is);
+		ReadStatus const ret = readFile(lex, fn);
+		if (ret == ReadSuccess && prepared.file_format != LYX_FORMAT) {
+			d->file_format = prepared.file_format;
+			d->need_format_backup = true;
+		}
+		return ret;
+	}
+
 	Lexer lex;
 	if (!lex.setFile(fn)) {
 		Alert::error(_("File Not Found"),
@@ -1194,7 +1487,12 @@ Buffer::ReadStatus Buffer::readFile(FileName const & fn)
 			        from_utf8(fn.absFileName())));
 		return ReadFileNotFound;
 	}
+	return readFile(lex, fn);
+}
+
 
+Buffer::ReadStatus Buffer::readFile(Lexer & lex, FileName const & fn)
+{
 	int file_format;
 	ReadStatus const ret_plf = parseLyXFormat(lex, fn, file_format);
 	if (ret_plf != ReadSuccess)
@@ -1229,6 +1527,9 @@ Buffer::ReadStatus Buffer::readFile(FileName const & fn)
 	d->read_only = !d->filename.isWritable();
 	params().compressed = theFormats().isZippedFile(d->filename);
 	saveCheckSum();
+	// The children are loaded one by one later on, read them in
+	// advance in parallel.
+	d->prepareChildren();
 	return ReadSuccess;
 }
 
@@ -1291,24 +1592,13 @@ void Buffer::updatePreviews() const
 Buffer::ReadStatus Buffer::parseLyXFormat(Lexer & lex,
 	FileName const & fn, int & file_format) const
 {
-	if(!lex.checkFor("\\lyxformat")) {
+	file_format = readLyXFormat(lex);
+	if (file_format == -1) {
 		Alert::error(_("Document format failure"),
 			bformat(_("%1$s is not a readable LyX document."),
 				from_utf8(fn.absFileName())));
 		return ReadNoLyXFormat;
 	}
-
-	string tmp_format;
-	lex >> tmp_format;
-
-	// LyX formats 217 and earlier were written as 2.17. This corresponds
-	// to files from LyX versions < 1.1.6.3. We just remove the dot in
-	// these cases. See also: www.lyx.org/trac/changeset/1313.
-	size_t dot = tmp_format.find_first_of(".,");
-	if (dot != string::npos)
-		tmp_format.erase(dot, 1);
-
-	file_format = convert<int>(tmp_format);
 	return ReadSuccess;
 }
 
@@ -1340,20 +1630,7 @@ Buffer::ReadStatus Buffer::convertLyXFormat(FileName const & fn,
 		return LyX2LyXNotFound;
 	}
 
-	// Run lyx2lyx:
-	//   $python$ "$lyx2lyx$" -t $LYX_FORMAT$ -o "$tempfile$" "$filetoread$"
-	ostringstream command;
-	command << os::python()
-		<< ' ' << quoteName(lyx2lyx.toFilesystemEncoding())
-		<< " -t " << convert<string>(LYX_FORMAT)
-		<< " -o " << quoteName(tmpfile.toSafeFilesystemEncoding())
-		<< ' ' << quoteName(fn.toSafeFilesystemEncoding());
-	string const command_str = command.str();
-
-	LYXERR(Debug::INFO, "Running '" << command_str << '\'');
-
-	cmd_ret const ret = runCommand(command_str);
-	if (!ret.valid) {
+	if (!runLyX2LyX(os::python(), lyx2lyx, fn, tmpfile)) {
 		if (from_format < LYX_FORMAT) {
 			Alert::error(_("Conversion script failed"),
 				bformat(_("%1$s is from an older version"
@@ -1434,6 +1711,21 @@ FileName Buffer::getBackupName() const {
 
 // Should probably be moved to somewhere else: BufferView? GuiView?
 bool Buffer::save() const
+{
+	if (!checkSave())
+		return false;
+
+	// We don't need autosaves in the immediate future. (Asger)
+	resetAutosaveTimers();
+
+	markSaveSnapshot();
+	SaveResult const result = saveFile(saveBackupName());
+	saveDone(result);
+	return result.success;
+}
+
+
+bool Buffer::checkSave() const
 {
 	docstring const file = makeDisplayPath(absFileName(), 20);
 	d->filename.refresh();
@@ -1459,17 +1751,57 @@ bool Buffer::save() const
 		if (ret == 1)
 			return false;
 	}
+	return true;
+}
 
-	// We don't need autosaves in the immediate future. (Asger)
-	resetAutosaveTimers();
+
+FileName Buffer::saveBackupName() const
+{
+	FileName backupName;
+	if (!lyxrc.make_backup && !d->need_format_backup)
+		return backupName;
+
+	if (d->need_format_backup)
+		backupName = getBackupName();
+
+	// If we for some reason failed to find a backup name in case of
+	// a format change, this will still set one. It's the best we can
+	// do in this case.
+	if (backupName.empty()) {
+		backupName.set(fileName().absFileName() + "~");
+		if (!lyxrc.backupdir_path.empty()) {
+			string const mangledName =
+				subst(subst(backupName.absFileName(), '/', '!'), ':', '!');
+			backupName.set(addName(lyxrc.backupdir_path, mangledName));
+		}
+	}
+	return backupName;
+}
+
+
+void Buffer::markSaveSnapshot() const
+{
+	d->save_snapshot_current = true;
+	d->save_in_progress = true;
+}
+
+
+bool Buffer::isSaving() const
+{
+	return d->save_in_progress;
+}
+
+
+Buffer::SaveResult Buffer::saveFile(FileName const & backupName) const
+{
+	SaveResult result;
 
 	// if the file does not yet exist, none of the backup activity
 	// that follows is necessary
 	if (!fileName().exists()) {
-		if (!writeFile(fileName()))
-			return false;
-		markClean();
-		return true;
+		result.success = writeFile(fileName());
+		result.checksum = d->checksum_;
+		return result;
 	}
 
 	// we first write the file to a new name, then move it to its
@@ -1488,29 +1820,13 @@ bool Buffer::save() const
 		LYXERR0("Failed to clone the permission from " << fileName().absFileName() << " to " << savefile.absFileName());
 
 	if (!writeFile(savefile))
-		return false;
+		return result;
 
 	// we will set this to false if we fail
 	bool made_backup = true;
 
-	FileName backupName;
-	bool const needBackup = lyxrc.make_backup || d->need_format_backup;
+	bool const needBackup = !backupName.empty();
 	if (needBackup) {
-		if (d->need_format_backup)
-			backupName = getBackupName();
-
-		// If we for some reason failed to find a backup name in case of
-		// a format change, this will still set one. It's the best we can
-		// do in this case.
-		if (backupName.empty()) {
-			backupName.set(fileName().absFileName() + "~");
-			if (!lyxrc.backupdir_path.empty()) {
-				string const mangledName =
-					subst(subst(backupName.absFileName(), '/', '!'), ':', '!');
-				backupName.set(addName(lyxrc.backupdir_path, mangledName));
-			}
-		}
-
 		LYXERR(Debug::FILES, "Backing up original file to " <<
 				backupName.absFileName());
 		// Except file is symlink do not copy because of #6587.
@@ -1520,16 +1836,13 @@ bool Buffer::save() const
 			fileName().moveTo(backupName);
 
 		if (!made_backup) {
-			Alert::error(_("Backup failure"),
+			result.errors.push_back(make_pair(_("Backup failure"),
 				     bformat(_("Cannot create backup file %1$s.\n"
 					       "Please check whether the directory exists and is writable."),
-					     from_utf8(backupName.absFileName())));
+					     from_utf8(backupName.absFileName()))));
 			//LYXERR(Debug::DEBUG, "Fs error: " << fe.what());
-		} else if (d->need_format_backup) {
-			// the original file has been backed up successfully, so we
-			// will not need to do that again
-			d->need_format_backup = false;
-		}
+		} else
+			result.made_backup = true;
 	}
 
 	// Destroy tempfile since it keeps the file locked on windows (bug 9234)
@@ -1544,10 +1857,9 @@ bool Buffer::save() const
 		// saveCheckSum() was already called by writeFile(), but the
 		// time stamp is invalidated by copying/moving
 		saveCheckSum();
-		markClean();
-		// the file associated with this buffer is now in the current format
-		d->file_format = LYX_FORMAT;
-		return true;
+		result.success = true;
+		result.checksum = d->checksum_;
+		return result;
 	}
 	// else we saved the file, but failed to move it to the right location.
 
@@ -1556,24 +1868,54 @@ bool Buffer::save() const
 		// to the user as if it was deleted. (see bug #9234.) we could try
 		// to restore it, but that would basically mean trying to do again
 		// what we just failed to do. better to leave things as they are.
-		Alert::error(_("Write failure"),
+		result.errors.push_back(make_pair(_("Write failure"),
 		             bformat(_("The file has successfully been saved as:\n  %1$s.\n"
 		                       "But LyX could not move it to:\n  %2$s.\n"
 		                       "Your original file has been backed up to:\n  %3$s"),
 		                     from_utf8(savefile.absFileName()),
 		                     from_utf8(fileName().absFileName()),
-		                     from_utf8(backupName.absFileName())));
+		                     from_utf8(backupName.absFileName()))));
 	} else {
 		// either we did not try to make a backup, or else we tried and failed,
 		// or else the original file was a symlink, in which case it was copied,
 		// not moved. so the original file is intact.
-		Alert::error(_("Write failure"),
+		result.errors.push_back(make_pair(_("Write failure"),
 			     bformat(_("Cannot move saved file to:\n  %1$s.\n"
 				       "But the file has successfully been saved as:\n  %2$s."),
 				     from_utf8(fileName().absFileName()),
-		         from_utf8(savefile.absFileName())));
+		         from_utf8(savefile.absFileName()))));
 	}
-	return false;
+	return result;
+}
+
+
+void Buffer::saveDone(SaveResult const & result) const
+{
+	for (auto const & error : result.errors)
+		Alert::error(error.first, error.second);
+
+	// the original file has been backed up successfully, so we
+	// will not need to do that again
+	if (result.made_backup)
+		d->need_format_backup = false;
+
+	d->save_in_progress = false;
+	bool const notified = d->notified_during_save;
+	d->notified_during_save = false;
+
+	if (result.success) {
+		d->checksum_ = result.checksum;
+		// Changes made while the snapshot was written still need saving
+		if (d->save_snapshot_current)
+			markClean();
+		// the file associated with this buffer is now in the current format
+		d->file_format = LYX_FORMAT;
+	}
+
+	// Now that the checksum of our own file is known, check whether
+	// the notification came from somebody else.
+	if (notified)
+		d->fileExternallyModified(d->filename.exists());
 }
 
 
@@ -2409,7 +2751,7 @@ void Buffer::getLabelList(vector<std::pair<docstring, docstring>> & list) const
 void Buffer::invalidateBibinfoCache() const
 {
 	d->bibinfo_cache_valid_ = false;
-	d->cite_labels_valid_ = false;
+	d->invalidateChangedCiteLabels();
 	removeBiblioTempFiles();
 	// also invalidate the cache for the parent buffer
 	Buffer const * const pbuf = d->parent();
@@ -2534,7 +2876,7 @@ void Buffer::checkIfBibInfoCacheIsValid() const
 	// OK. This is with Bib(la)tex. We'll assume the cache
 	// is valid and change this if we find changes in the bibs.
 	d->bibinfo_cache_valid_ = true;
-	d->cite_labels_valid_ = true;
+	d->setCiteLabelsValid();
 
 	// compare the cached timestamps with the actual ones.
 	docstring_list const & bibfiles_cache = getBibfiles();
@@ -2544,7 +2886,7 @@ void Buffer::checkIfBibInfoCacheIsValid() const
 		time_t prevw = d->bibfile_status_[fn];
 		if (lastw != prevw) {
 			d->bibinfo_cache_valid_ = false;
-			d->cite_labels_valid_ = false;
+			d->invalidateChangedCiteLabels();
 			d->bibfile_status_[fn] = lastw;
 		}
 	}
@@ -2582,11 +2924,23 @@ void Buffer::reloadBibInfoCache(bool const force) const
 	// in some other cases? If so, then it is easy enough to
 	// add the following line in some other places.
 	clearBibFileCache();
+	BiblioInfo const old_bibinfo = move(d->bibinfo_);
 	d->bibinfo_.clear();
 	FileNameList checkedFiles;
 	d->have_bibitems_ = false;
 	collectBibKeys(checkedFiles);
 	d->bibinfo_cache_valid_ = true;
+
+	if (!d->cite_labels_valid_ && d->cite_labels_partly_valid_) {
+		if (params().citeEngineType() & ENGINE_TYPE_NUMERICAL) {
+			// The numbers of all entries depend on each other
+			d->cite_labels_partly_valid_ = false;
+		} else {
+			set<docstring> const changed = d->bibinfo_.changedKeys(old_bibinfo);
+			LYXERR(Debug::FILES, changed.size() << " bibliography entries changed.");
+			d->changed_cite_keys_.insert(changed.begin(), changed.end());
+		}
+	}
 }
 
 
@@ -2645,6 +2999,7 @@ void Buffer::makeCitationLabels() const
 void Buffer::invalidateCiteLabels() const
 {
 	masterBuffer()->d->cite_labels_valid_ = false;
+	masterBuffer()->d->cite_labels_partly_valid_ = false;
 }
 
 bool Buffer::citeLabelsValid() const
@@ -2653,6 +3008,23 @@ bool Buffer::citeLabelsValid() const
 }
 
 
+bool Buffer::citeLabelsValid(vector<docstring> const & keys) const
+{
+	Impl const * const md = masterBuffer()->d;
+	if (md->cite_labels_valid_)
+		return true;
+	// We only know which entries have changed once the bibinfo
+	// cache has been reloaded.
+	if (!md->cite_labels_partly_valid_ || !md->bibinfo_cache_valid_)
+		return false;
+	for (auto const & key : keys) {
+		if (md->changed_cite_keys_.find(key) != md->changed_cite_keys_.end())
+			return false;
+	}
+	return true;
+}
+
+
 void Buffer::removeBiblioTempFiles() const
 {
 	// We remove files that contain LaTeX commands specific to the
@@ -3241,6 +3613,7 @@ void Buffer::markDirty()
 		updateTitles();
 	}
 	d->bak_clean = false;
+	d->save_snapshot_current = false;
 
 	for (auto & depit : d->dep_clean)
 		depit.second = false;
@@ -3752,6 +4125,9 @@ void Buffer::Impl::updateMacros(DocIterator & it, DocIterator & scope)
 				// Inset needs its own scope?
 				InsetText const * itext = insit.inset->asInsetText();
 				bool newScope = itext->isMacroScope();
+				if (newScope)
+					macro_anchors.push_back(
+						MacroAnchor(it, insit.inset, docstring()));
 
 				// scope which ends just behind the inset
 				DocIterator insetScope = it;
@@ -3780,6 +4156,8 @@ void Buffer::Impl::updateMacros(DocIterator & it, DocIterator & scope)
 				// get buffer of external file
 				InsetInclude const & incinset =
 					static_cast<InsetInclude const &>(*insit.inset);
+				macro_anchors.push_back(
+					MacroAnchor(it, insit.inset, docstring()));
 				macro_lock = true;
 				Buffer * child = incinset.loadIfNeeded();
 				macro_lock = false;
@@ -3813,6 +4191,8 @@ void Buffer::Impl::updateMacros(DocIterator & it, DocIterator & scope)
 
 			// valid?
 			bool valid = macroTemplate.validMacro();
+			macro_anchors.push_back(MacroAnchor(it, insit.inset,
+				valid ? macroTemplate.name() : docstring()));
 			// FIXME: Should be fixNameAndCheckIfValid() in fact,
 			// then the BufferView's cursor will be invalid in
 			// some cases which leads to crashes.
@@ -3833,6 +4213,106 @@ void Buffer::Impl::updateMacros(DocIterator & it, DocIterator & scope)
 }
 
 
+bool Buffer::Impl::sameMacroAnchor(DocIterator const & it,
+	Inset const * inset, docstring const & name, size_t & idx) const
+{
+	if (idx >= macro_anchors.size())
+		return false;
+	MacroAnchor const & anchor = macro_anchors[idx++];
+	return anchor.inset == inset && anchor.name == name && anchor.pos == it;
+}
+
+
+bool Buffer::Impl::sameMacroAnchors(DocIterator & it, pit_type lastpit,
+	size_t & idx) const
+{
+	// This follows the traversal of updateMacros above
+	for (; it.pit() <= lastpit; ++it.pit()) {
+		Paragraph const & par = it.paragraph();
+
+		for (auto const & insit : par.insetList()) {
+			it.pos() = insit.pos;
+
+			if (InsetText const * itext = insit.inset->asInsetText()) {
+				if (itext->isMacroScope()
+				    && !sameMacroAnchor(it, insit.inset, docstring(), idx))
+					return false;
+				it.push_back(CursorSlice(*insit.inset));
+				bool const same = sameMacroAnchors(it, it.lastpit(), idx);
+				it.pop_back();
+				if (!same)
+					return false;
+				continue;
+			}
+
+			if (insit.inset->asInsetTabular()) {
+				CursorSlice slice(*insit.inset);
+				size_t const numcells = slice.nargs();
+				for (; slice.idx() < numcells; slice.forwardIdx()) {
+					it.push_back(slice);
+					bool const same = sameMacroAnchors(it, it.lastpit(), idx);
+					it.pop_back();
+					if (!same)
+						return false;
+				}
+				continue;
+			}
+
+			if (insit.inset->lyxCode() == INCLUDE_CODE) {
+				if (!sameMacroAnchor(it, insit.inset, docstring(), idx))
+					return false;
+				continue;
+			}
+
+			if (insit.inset->lyxCode() != MATHMACRO_CODE)
+				continue;
+
+			InsetMathMacroTemplate const & macroTemplate =
+				*insit.inset->asInsetMath()->asMacroTemplate();
+			docstring const name = macroTemplate.validMacro()
+				? macroTemplate.name() : docstring();
+			if (!sameMacroAnchor(it, insit.inset, name, idx))
+				return false;
+		}
+		it.pos() = 0;
+	}
+	return true;
+}
+
+
+bool Buffer::Impl::macroChangeKeepsAnchors() const
+{
+	DocIterator it = macro_change_cell;
+	if (it.fixIfBroken())
+		return false;
+
+	// Anchors in or behind the changed paragraphs of the cell might
+	// have been moved or removed.
+	size_t const depth = it.depth();
+	for (MacroAnchor const & anchor : macro_anchors) {
+		if (anchor.pos.depth() < depth)
+			continue;
+		bool inside = true;
+		for (size_t i = 0; inside && i + 1 < depth; ++i)
+			inside = anchor.pos[i] == it[i];
+		CursorSlice const & slice = anchor.pos[depth - 1];
+		if (inside && &slice.inset() == &it.inset()
+		    && slice.idx() == it.idx() && slice.pit() >= macro_change_from)
+			return false;
+	}
+
+	// Math cells cannot contain any anchor
+	if (it.inMathed())
+		return true;
+
+	// Look for new anchors in the changed paragraphs. As there is no
+	// anchor left to compare with, any anchor found is a mismatch.
+	it.pit() = macro_change_from;
+	size_t idx = macro_anchors.size();
+	return sameMacroAnchors(it, it.lastpit() - macro_change_end, idx);
+}
+
+
 void Buffer::updateMacros() const
 {
 	if (d->macro_lock)
@@ -3844,6 +4324,7 @@ void Buffer::updateMacros() const
 	d->macros.clear();
 	d->children_positions.clear();
 	d->position_to_children.clear();
+	d->macro_anchors.clear();
 
 	// Iterate over buffer, starting with first paragraph
 	// The scope must be bigger than any lookup DocIterator
@@ -3852,7 +4333,75 @@ void Buffer::updateMacros() const
 	DocIterator it = par_iterator_begin();
 	DocIterator outerScope = it;
 	outerScope.pit() = outerScope.lastpit() + 2;
+	d->macro_lastpit = it.lastpit();
 	d->updateMacros(it, outerScope);
+	d->macro_anchors_valid = true;
+	d->macro_change_cell.clear();
+	d->macro_changes_scattered = false;
+}
+
+
+void Buffer::refreshMacros() const
+{
+	if (d->macro_lock)
+		return;
+
+	// A child might have been closed in the meantime
+	bool valid = d->macro_anchors_valid;
+	for (auto const & p : d->children_positions)
+		if (!theBufferList().isLoaded(p.first))
+			valid = false;
+
+	DocIterator it = par_iterator_begin();
+	if (valid && it.lastpit() == d->macro_lastpit) {
+		bool same;
+		if (d->macro_changes_scattered) {
+			// Compare all anchors of the document
+			size_t idx = 0;
+			same = d->sameMacroAnchors(it, it.lastpit(), idx)
+				&& idx == d->macro_anchors.size();
+		} else if (d->macro_change_cell.empty())
+			// Nothing has been changed
+			return;
+		else
+			same = d->macroChangeKeepsAnchors();
+
+		if (same) {
+			// The tables are still correct, but the contents of
+			// the macro templates may have changed.
+			for (auto const & nameit : d->macros)
+				for (auto const & posit : nameit.second)
+					posit.second.macro.requery();
+			d->macro_change_cell.clear();
+			d->macro_changes_scattered = false;
+			return;
+		}
+	}
+	updateMacros();
+}
+
+
+void Buffer::recordParagraphChange(DocIterator const & cell,
+	pit_type from, pit_type end) const
+{
+	// Nothing to track if the macro tables will be rebuilt anyway
+	if (!d->macro_anchors_valid || d->macro_changes_scattered)
+		return;
+
+	DocIterator c = cell;
+	c.top().pit() = 0;
+	c.top().pos() = 0;
+	if (d->macro_change_cell.empty()) {
+		d->macro_change_cell = c;
+		d->macro_change_from = from;
+		d->macro_change_end = end;
+	} else if (d->macro_change_cell == c) {
+		// Paragraphs before the first and after the last change
+		// are untouched.
+		d->macro_change_from = min(d->macro_change_from, from);
+		d->macro_change_end = min(d->macro_change_end, end);
+	} else
+		d->macro_changes_scattered = true;
 }
 
 
@@ -3887,6 +4436,10 @@ void Buffer::updateMacroInstances(UpdateType utype) const
 {
 	LYXERR(Debug::MACROS, "updateMacroInstances for "
 		<< d->filename.onlyFileName());
+	// FIXME: Only the instances of macros whose definitions changed
+	// need an update. But every instance caches a pointer into the
+	// macro tables, which updateMacros rebuilds from scratch, so all
+	// of them have to be visited.
 	DocIterator it = doc_iterator_begin(this);
 	it.forwardInset();
 	DocIterator const end = doc_iterator_end(this);
@@ -5042,7 +5595,7 @@ void Buffer::updateBuffer(UpdateScope scope, UpdateType utype) const
 		// this is also set to true on the other path, by reloadBibInfoCache.
 		d->bibinfo_cache_valid_ = true;
 	}
-	d->cite_labels_valid_ = true;
+	d->setCiteLabelsValid();
 	/// FIXME: Perf
 	clearIncludeList();
 	cbuf.tocBackend().update(true, utype);
@@ -5344,9 +5897,21 @@ int Buffer::spellCheck(DocIterator & from, DocIterator & to,
 		// when "from" was changed above) LyX will crash later otherwise.
 		if (from.atEnd() || (!to_end && from >= end))
 			break;
+		Paragraph const & par = from.paragraph();
+		// Check the whole paragraph at once and jump directly to the
+		// next misspelled word (or inset) using the stored results.
+		par.spellCheck();
+		if (from.inTexted()) {
+			pos_type limit = from.lastpos();
+			if (!to_end && end.depth() == from.depth()
+			    && &end.paragraph() == &par)
+				limit = min(limit, end.pos());
+			from.pos() = par.skipSpellChecked(from.pos(), limit, progress);
+			if (!to_end && from >= end)
+				break;
+		}
 		to = from;
-		from.paragraph().spellCheck();
-		SpellChecker::Result res = from.paragraph().spellCheck(from.pos(), to.pos(), wl, suggestions);
+		SpellChecker::Result res = par.spellCheck(from.pos(), to.pos(), wl, suggestions);
 		if (SpellChecker::misspelled(res)) {
 			word_lang = wl;
 			break;
@@ -5547,6 +6112,7 @@ void Buffer::checkChildBuffers()
 	// invalidate cache of children
 	d->children_positions.clear();
 	d->position_to_children.clear();
+	d->macro_anchors_valid = false;
 }
 
 
@@ -5620,6 +6186,11 @@ void Buffer::Impl::refreshFileMonitor()
 
 void Buffer::Impl::fileExternallyModified(bool const exists)
 {
+	// the checksum of the file being written is not known yet
+	if (save_in_progress) {
+		notified_during_save = true;
+		return;
+	}
 	// ignore notifications after our own saving operations
 	if (checksum_ == filename.checksum()) {
 		LYXERR(Debug::FILES, "External modification but "
@@ -146,6 +146,20 @@ public:
 		UpdateChildOnly
 	};
 
+	/// Outcome of saveFile()
+	struct SaveResult {
+		/// was the file written to its final location?
+		bool success = false;
+		/// has the original file been backed up?
+		bool made_backup = false;
+		/// checksum of the written file
+		unsigned long checksum = 0;
+		/// the title and text of the errors to show to the user. They
+		/// are shown by saveDone(), since saveFile() may run in
+		/// another thread.
+		std::vector<std::pair<docstring, docstring>> errors;
+	};
+
 	/// Constructor
 	explicit Buffer(std::string const & file, bool readonly = false,
 		Buffer const * cloned_buffer = nullptr);
@@ -189,6 +203,32 @@ public:
 	/// Renames and saves the buffer
 	bool saveAs(support::FileName const & fn);
 
+	/** The parts of save(), so that the writing can be done from a
+	    snapshot (made with cloneBufferOnly()) in another thread.
+	    First, checkSave() makes sure the file may be overwritten,
+	    asking the user if needed. Then saveBackupName() and
+	    markSaveSnapshot() are called on the buffer, and saveFile() on
+	    the snapshot. Finally, saveDone() is called on the buffer.
+	*/
+	bool checkSave() const;
+	/// The name of the backup of the original file, empty if
+	/// no backup is needed
+	support::FileName saveBackupName() const;
+	/// Remember that the current contents are the ones being saved.
+	/// File monitor notifications are held back until saveDone().
+	void markSaveSnapshot() const;
+	/// Write the buffer to its file name through a temporary file,
+	/// moving the original file to \p backup first if it is not empty.
+	/// This does not change the state of the buffer.
+	SaveResult saveFile(support::FileName const & backup) const;
+	/// Update the state of the buffer after saveFile() and report its
+	/// errors. The buffer is only marked clean if it has not changed
+	/// since markSaveSnapshot().
+	void saveDone(SaveResult const & result) const;
+	/// Is the file being written, i.e. has saveDone() not been called
+	/// yet after markSaveSnapshot()?
+	bool isSaving() const;
+
 	/// Write document to stream. Returns \c false if unsuccessful.
 	bool write(std::ostream &) const;
 	/// Write file. Returns \c false if unsuccessful.
@@ -231,6 +271,8 @@ private:
 	void saveCheckSum() const;
 	/// read a new file
 	ReadStatus readFile(support::FileName const & fn);
+	/// read a new file from \p lex, \p fn is the name of the file
+	ReadStatus readFile(Lexer & lex, support::FileName const & fn);
 	/// Reads a file without header.
 	/// \param par if != 0 insert the file.
 	/// \return \c true if file is not completely read.
@@ -521,6 +563,9 @@ public:
 	void invalidateCiteLabels() const;
 	///
 	bool citeLabelsValid() const;
+	/// Are the labels of citations of \p keys valid? This is the case
+	/// if only the entries of other keys have changed.
+	bool citeLabelsValid(std::vector<docstring> const & keys) const;
 	/// two strings: plain label name and label as gui string
 	void getLabelList(std::vector<std::pair<docstring, docstring>> &) const;
 
@@ -601,6 +646,15 @@ public:
 	//
 	/// Collect macro definitions in paragraphs
 	void updateMacros() const;
+	/// Like updateMacros, but only rebuild the macro tables if macro
+	/// templates, included children or macro scopes have been added,
+	/// removed, renamed or moved since the last update. Only the
+	/// paragraphs passed to recordParagraphChange are looked at.
+	void refreshMacros() const;
+	/// Tell refreshMacros that the paragraphs \p from to
+	/// lastpit - \p end of \p cell are going to be changed.
+	void recordParagraphChange(DocIterator const & cell,
+		pit_type from, pit_type end) const;
 	/// Iterate through the whole buffer and try to resolve macros
 	void updateMacroInstances(UpdateType) const;
 
@@ -2693,6 +2693,24 @@ void BufferParams::makeDocumentClass(bool clone, bool internal)
 		return;
 
 	invalidateConverterCache();
+
+	// Buffers with the same settings get a copy of the same document
+	// class, so that the modules are not read again for every child
+	// document. Clones are used in other threads and build their own class.
+	DocumentClassKey key;
+	if (!clone) {
+		key.baseclass = baseClass()->name();
+		key.modules.assign(layout_modules_.begin(), layout_modules_.end());
+		key.cite_engine = cite_engine_;
+		key.forced_local_layout = forced_local_layout_;
+		key.local_layout = local_layout_;
+		key.internal = internal;
+		if (DocumentClassPtr dc = findDocumentClass(key)) {
+			doc_class_ = dc;
+			return;
+		}
+	}
+
 	LayoutModuleList mods;
 	for (auto const & mod : layout_modules_)
 		mods.push_back(mod);
@@ -2710,6 +2728,9 @@ void BufferParams::makeDocumentClass(bool clone, bool internal)
 		docstring const msg = _("Error reading internal layout information");
 		frontend::Alert::warning(_("Read Error"), msg);
 	}
+
+	if (!clone)
+		registerDocumentClass(key, doc_class_);
 }
 
 
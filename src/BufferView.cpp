@@ -512,13 +512,12 @@ void BufferView::processUpdateFlags(Update::flags flags)
 	if (flags == Update::None)
 		return;
 
-	/* FIXME We would like to avoid doing this here, since it is very
-	 * expensive and is called in updateBuffer already. However, even
-	 * inserting a plain character can invalidate the overly fragile
-	 * tables of child documents built by updateMacros. Some work is
-	 * needed to avoid doing that when not necessary.
+	/* Even inserting a plain character can invalidate the overly
+	 * fragile tables of child documents built by updateMacros.
+	 * refreshMacros only rebuilds them when the positions of macro
+	 * templates, children or macro scopes have actually changed.
 	 */
-	buffer_.updateMacros();
+	buffer_.refreshMacros();
 
 	// First check whether the metrics and inset positions should be updated
 	if (flags & Update::Force) {
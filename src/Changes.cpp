@@ -36,6 +36,8 @@
 #include "frontends/FontMetrics.h"
 #include "frontends/Painter.h"
 
+#include <algorithm>
+#include <limits>
 #include <ostream>
 
 using namespace std;
@@ -258,6 +260,19 @@ Change const & Changes::lookup(pos_type const pos) const
 }
 
 
+pos_type Changes::lookupEnd(pos_type const pos) const
+{
+	pos_type end = numeric_limits<pos_type>::max();
+	for (ChangeRange const & cr : table_) {
+		if (cr.range.contains(pos))
+			return cr.range.end;
+		if (cr.range.start > pos)
+			end = min(end, cr.range.start);
+	}
+	return end;
+}
+
+
 bool Changes::isDeleted(pos_type start, pos_type end) const
 {
 	for (ChangeRange const & cr : table_)
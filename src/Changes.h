@@ -111,6 +111,9 @@ public:
 
 	/// return the change at the given pos
 	Change const & lookup(pos_type pos) const;
+	/// return the first position after \p pos where the change may
+	/// differ from the one at \p pos
+	pos_type lookupEnd(pos_type pos) const;
 
 	/// return true if there is a change in the given range (excluding end)
 	bool isChanged(pos_type start, pos_type end) const;
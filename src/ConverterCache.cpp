@@ -27,6 +27,7 @@
 
 #include "support/checksum.h"
 #include "support/lassert.h"
+#include "support/mutex.h"
 
 #include <algorithm>
 #include <fstream>
@@ -95,6 +96,9 @@ public:
 	///
 	CacheItem * find(FileName const & from, string const & format);
 	CacheType cache;
+	/// Documents are converted with lyx2lyx in worker threads
+	/// (see Buffer::Impl::prepareChildren()), which use the cache too.
+	Mutex mutex;
 };
 
 
@@ -252,6 +256,7 @@ void ConverterCache::writeIndex() const
 	if (!lyxrc.use_converter_cache
 		  || cache_dir.empty())
 		return;
+	Mutex::Locker lock(&pimpl_->mutex);
 	pimpl_->writeIndex();
 }
 
@@ -262,6 +267,7 @@ void ConverterCache::add(FileName const & orig_from, string const & to_format,
 	if (!lyxrc.use_converter_cache || orig_from.empty() ||
 	    converted_file.empty())
 		return;
+	Mutex::Locker lock(&pimpl_->mutex);
 	LYXERR(Debug::FILES, ' ' << orig_from
 			     << ' ' << to_format << ' ' << converted_file);
 
@@ -329,6 +335,7 @@ void ConverterCache::remove(FileName const & orig_from,
 {
 	if (!lyxrc.use_converter_cache || orig_from.empty())
 		return;
+	Mutex::Locker lock(&pimpl_->mutex);
 	LYXERR(Debug::FILES, orig_from << ' ' << to_format);
 
 	CacheType::iterator const it1 = pimpl_->cache.find(orig_from);
@@ -350,6 +357,7 @@ void ConverterCache::remove_all(string const & from_format,
 {
 	if (!lyxrc.use_converter_cache)
 		return;
+	Mutex::Locker lock(&pimpl_->mutex);
 	CacheType::iterator it1 = pimpl_->cache.begin();
 	while (it1 != pimpl_->cache.end()) {
 		if (it1->second.from_format != from_format) {
@@ -389,6 +397,7 @@ bool ConverterCache::inCache(FileName const & orig_from,
 {
 	if (!lyxrc.use_converter_cache || orig_from.empty())
 		return false;
+	Mutex::Locker lock(&pimpl_->mutex);
 	LYXERR(Debug::FILES, orig_from << ' ' << to_format);
 
 	CacheItem * const item = pimpl_->find(orig_from, to_format);
@@ -428,6 +437,7 @@ bool ConverterCache::inCache(FileName const & orig_from,
 FileName const & ConverterCache::cacheName(FileName const & orig_from,
 		string const & to_format) const
 {
+	Mutex::Locker lock(&pimpl_->mutex);
 	LYXERR(Debug::FILES, orig_from << ' ' << to_format);
 
 	CacheItem * const item = pimpl_->find(orig_from, to_format);
@@ -441,6 +451,7 @@ bool ConverterCache::copy(FileName const & orig_from, string const & to_format,
 {
 	if (!lyxrc.use_converter_cache || orig_from.empty() || dest.empty())
 		return false;
+	Mutex::Locker lock(&pimpl_->mutex);
 	LYXERR(Debug::FILES, orig_from << ' ' << to_format << ' ' << dest);
 
 	// FIXME: Should not hardcode this (see bug 3819 for details)
@@ -65,6 +65,7 @@
 #include "frontends/alert.h"
 #include "frontends/Clipboard.h"
 
+#include <memory>
 #include <string>
 #include <tuple>
 
@@ -601,11 +602,12 @@ Buffer * copyToTempBuffer(ParagraphList const & paragraphs, DocumentClassConstPt
 }
 
 
-void putClipboard(ParagraphList const & paragraphs,
-		  DocInfoPair docinfo, docstring const & plaintext,
-		  BufferParams const & bp)
+/// Produce the LyX and XHTML versions of \p paragraphs for the clipboard
+void renderClipboard(ParagraphList const & paragraphs,
+		DocumentClassConstPtr docclass, AuthorList const & authors,
+		string & lyx, docstring & html)
 {
-	Buffer * buffer = copyToTempBuffer(paragraphs, docinfo.first);
+	Buffer * buffer = copyToTempBuffer(paragraphs, docclass);
 	if (!buffer) // already asserted in copyToTempBuffer()
 		return;
 
@@ -615,7 +617,7 @@ void putClipboard(ParagraphList const & paragraphs,
 	buffer->params().html_math_output = BufferParams::MathML;
 
 	// Copy authors to the params. We need those pointers.
-	for (Author const & a : bp.authors())
+	for (Author const & a : authors)
 		buffer->params().authors().record(a);
 
 	// Make sure MarkAsExporting is deleted before buffer is
@@ -629,7 +631,6 @@ void putClipboard(ParagraphList const & paragraphs,
 		buffer->updateMacroInstances(OutputUpdate);
 
 		// LyX's own format
-		string lyx;
 		ostringstream oslyx;
 		if (buffer->write(oslyx))
 			lyx = oslyx.str();
@@ -642,8 +643,7 @@ void putClipboard(ParagraphList const & paragraphs,
 		// We are not interested in errors (bug 8866)
 		runparams.silent = true;
 		buffer->writeLyXHTMLSource(oshtml, runparams, Buffer::FullSource);
-
-		theClipboard().put(lyx, oshtml.str(), plaintext);
+		html = oshtml.str();
 	}
 
 	// Save that memory
@@ -651,6 +651,24 @@ void putClipboard(ParagraphList const & paragraphs,
 }
 
 
+void putClipboard(ParagraphList const & paragraphs,
+		  DocInfoPair docinfo, docstring const & plaintext,
+		  BufferParams const & bp)
+{
+	// The LyX and XHTML formats need a complete temporary Buffer, which
+	// is expensive for large selections. Pasting into this instance of
+	// LyX uses the cut stack, so these formats are only produced when
+	// another application asks for them.
+	shared_ptr<ParagraphList const> const pars =
+		make_shared<ParagraphList const>(paragraphs);
+	DocumentClassConstPtr const docclass = docinfo.first;
+	AuthorList const authors = bp.authors();
+	theClipboard().put([pars, docclass, authors](string & lyx, docstring & html) {
+			renderClipboard(*pars, docclass, authors, lyx, html);
+		}, plaintext);
+}
+
+
 /// return true if the whole ParagraphList is deleted
 static bool isFullyDeleted(ParagraphList const & pars)
 {
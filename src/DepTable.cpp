@@ -17,15 +17,116 @@
 #include "support/debug.h"
 #include "support/FileName.h"
 #include "support/lstrings.h"
-#include "support/lyxtime.h"
 
+#include <QElapsedTimer>
+#include <QRunnable>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <atomic>
 #include <fstream>
+#include <future>
+#include <memory>
+#include <sstream>
+#include <vector>
 
 using namespace std;
 using namespace lyx::support;
 
 namespace lyx {
 
+namespace {
+
+/// The state of a file in the file system
+struct FileState {
+	FileState() : exists(false), mtime(0), size(0), crc(0), hashed(false) {}
+	///
+	bool exists;
+	/// 0 if the file may still change without changing its mtime
+	time_t mtime;
+	///
+	long long size;
+	/// only valid if hashed is true
+	unsigned long crc;
+	///
+	bool hashed;
+};
+
+
+/// The mtime has a resolution of one second. If the file has been
+/// modified in the second we started to look at it, it can be modified
+/// again without changing its mtime and size. \returns 0 in this case,
+/// so that the checksum is computed again next time, and \p mtime
+/// otherwise.
+time_t reliableMTime(time_t const mtime, time_t const start)
+{
+	return mtime < start ? mtime : 0;
+}
+
+
+/// The files DepTable::update() has to look at. The work is shared
+/// between the calling thread and threads of the global thread pool.
+class DepJobs {
+public:
+	///
+	struct Job {
+		Job(FileName const & f, time_t m, long long s)
+			: file(f), mtime(m), size(s) {}
+		/// a copy, since FileName is not thread safe
+		FileName const file;
+		/// the known mtime and size of the file
+		time_t const mtime;
+		long long const size;
+		///
+		FileState result;
+		///
+		promise<void> done;
+	};
+	///
+	DepJobs() : next_(0) {}
+	/// Process jobs until none is left
+	void work()
+	{
+		for (size_t i = next_++; i < jobs.size(); i = next_++) {
+			Job & job = jobs[i];
+			FileState & st = job.result;
+			time_t const start = time(nullptr);
+			st.exists = job.file.exists();
+			if (st.exists) {
+				st.mtime = job.file.lastModified();
+				st.size = job.file.fileSize();
+				// Only compute the checksum if the file
+				// might have changed.
+				if (st.mtime != job.mtime || st.size != job.size) {
+					st.crc = job.file.checksum();
+					st.hashed = true;
+				}
+				st.mtime = reliableMTime(st.mtime, start);
+			}
+			job.done.set_value();
+		}
+	}
+	///
+	vector<Job> jobs;
+private:
+	///
+	atomic<size_t> next_;
+};
+
+
+class DepTask : public QRunnable
+{
+public:
+	DepTask(shared_ptr<DepJobs> const & jobs) : jobs_(jobs) {}
+	///
+	void run() override { jobs_->work(); }
+private:
+	/// shared, since the task may only start after update() is done
+	shared_ptr<DepJobs> const jobs_;
+};
+
+} // namespace
+
 
 inline
 bool DepTable::dep_info::changed() const
@@ -40,13 +141,16 @@ void DepTable::insert(FileName const & f, bool upd)
 		dep_info di;
 		di.crc_prev = 0;
 		if (upd && f.exists()) {
+			time_t const start = time(nullptr);
 			LYXERR(Debug::DEPEND, " CRC...");
 			di.crc_cur = f.checksum();
 			LYXERR(Debug::DEPEND, "done.");
-			di.mtime_cur = f.lastModified();
+			di.mtime_cur = reliableMTime(f.lastModified(), start);
+			di.size_cur = f.fileSize();
 		} else {
 			di.crc_cur = 0;
 			di.mtime_cur = 0;
+			di.size_cur = -1;
 		}
 		deplist[f] = di;
 	} else {
@@ -58,22 +162,50 @@ void DepTable::insert(FileName const & f, bool upd)
 void DepTable::update()
 {
 	LYXERR(Debug::DEPEND, "Updating DepTable...");
-	time_t const start_time = current_time();
-
+	QElapsedTimer timer;
+	timer.start();
+
+	// Checking the files and computing the checksums of the changed
+	// ones is done in parallel. The results are merged in the order
+	// of the list below, so that the outcome does not depend on the
+	// scheduling.
+	shared_ptr<DepJobs> const jobs = make_shared<DepJobs>();
+	jobs->jobs.reserve(deplist.size());
+	vector<future<void>> done;
+	done.reserve(deplist.size());
+	for (auto const & dep : deplist) {
+		jobs->jobs.emplace_back(dep.first, dep.second.mtime_cur,
+		                        dep.second.size_cur);
+		done.push_back(jobs->jobs.back().done.get_future());
+	}
+	QThreadPool * pool = QThreadPool::globalInstance();
+	int const nthreads = min(pool->maxThreadCount(), int(deplist.size())) - 1;
+	for (int i = 0; i < nthreads; ++i)
+		pool->start(new DepTask(jobs));
+	// Work in this thread as well, so that we cannot be blocked by a
+	// busy thread pool.
+	jobs->work();
+	for (future<void> const & f : done)
+		f.wait();
+
+	size_t nhashed = 0;
+	vector<DepJobs::Job>::const_iterator job = jobs->jobs.begin();
 	DepList::iterator itr = deplist.begin();
 	while (itr != deplist.end()) {
 		FileName const & fn = itr->first;
 		dep_info &di = itr->second;
+		FileState const & st = (job++)->result;
 
-		if (fn.exists()) {
-			if (di.mtime_cur == fn.lastModified()) {
-				di.crc_prev = di.crc_cur;
-				LYXERR(Debug::DEPEND, itr->first << " same mtime");
+		if (st.exists) {
+			di.crc_prev = di.crc_cur;
+			if (!st.hashed) {
+				LYXERR(Debug::DEPEND, itr->first << " same mtime and size");
 			} else {
-				di.crc_prev = di.crc_cur;
-				LYXERR(Debug::DEPEND, itr->first << " CRC... ");
-				di.crc_cur = fn.checksum();
-				LYXERR(Debug::DEPEND, "done");
+				LYXERR(Debug::DEPEND, itr->first << " CRC computed");
+				di.crc_cur = st.crc;
+				di.mtime_cur = st.mtime;
+				di.size_cur = st.size;
+				++nhashed;
 			}
 		} else {
 			// file doesn't exist
@@ -92,9 +224,10 @@ void DepTable::update()
 		}
 		++itr;
 	}
-	time_t const time_sec = current_time() - start_time;
-	LYXERR(Debug::DEPEND, "Finished updating DepTable ("
-		<< long(time_sec) << " sec).");
+	LYXERR(Debug::DEPEND, "Finished updating DepTable: "
+		<< jobs->jobs.size() << " files checked, " << nhashed
+		<< " hashed using " << nthreads + 1 << " threads ("
+		<< timer.elapsed() << " ms).");
 }
 
 
@@ -203,10 +336,12 @@ void DepTable::write(FileName const & f) const
 		LYXERR(Debug::DEPEND, "Write dep: "
 		       << cit->second.crc_cur << ' '
 		       << cit->second.mtime_cur << ' '
+		       << cit->second.size_cur << ' '
 		       << cit->first);
 
 		ofs << cit->second.crc_cur << ' '
 		    << cit->second.mtime_cur << ' '
+		    << cit->second.size_cur << ' '
 		    << cit->first << endl;
 	}
 }
@@ -222,9 +357,18 @@ bool DepTable::read(FileName const & f)
 
 	while (ifs >> di.crc_cur >> di.mtime_cur && getline(ifs, nome)) {
 		nome = ltrim(nome);
+		// Older dep files do not contain the size. The file names
+		// are absolute, so they do not start with a number.
+		di.size_cur = -1;
+		string size;
+		string const rest = split(nome, size, ' ');
+		if (!rest.empty() && (isStrUnsignedInt(size) || size == "-1")) {
+			istringstream(size) >> di.size_cur;
+			nome = rest;
+		}
 
-		LYXERR(Debug::DEPEND, "Read dep: "
-		       << di.crc_cur << ' ' << di.mtime_cur << ' ' << nome);
+		LYXERR(Debug::DEPEND, "Read dep: " << di.crc_cur << ' '
+		       << di.mtime_cur << ' ' << di.size_cur << ' ' << nome);
 
 		deplist[FileName(nome)] = di;
 	}
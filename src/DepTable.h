@@ -60,6 +60,9 @@ private:
 		unsigned long crc_cur;
 		/// mtime from last time current CRC was calculated.
 		std::time_t mtime_cur;
+		/// size from last time current CRC was calculated,
+		/// -1 if unknown.
+		long long size_cur;
 		///
 		bool changed() const;
 	};
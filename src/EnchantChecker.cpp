@@ -15,6 +15,7 @@
 
 #include "EnchantChecker.h"
 #include "LyXRC.h"
+#include "SpellResultCache.h"
 #include "WordLangTuple.h"
 
 #include "support/lassert.h"
@@ -64,6 +65,8 @@ struct EnchantChecker::Private
 
 	/// the spellers
 	Spellers spellers_;
+	/// results of previous dictionary lookups
+	SpellResultCache cache_;
 };
 
 
@@ -129,9 +132,12 @@ SpellChecker::Result EnchantChecker::check(WordLangTuple const & word,
 	if (word.word().empty())
 		return WORD_OK;
 
-	string utf8word = to_utf8(word.word());
-
-	if (m->check(utf8word))
+	Result res;
+	if (!d->cache_.result(word, changeNumber(), res)) {
+		res = m->check(to_utf8(word.word())) ? WORD_OK : UNKNOWN_WORD;
+		d->cache_.setResult(word, changeNumber(), res);
+	}
+	if (res == WORD_OK)
 		return WORD_OK;
 
 	vector<WordLangTuple>::const_iterator it = docdict.begin();
@@ -191,6 +197,9 @@ void EnchantChecker::suggest(WordLangTuple const & wl,
 	if (!m)
 		return;
 
+	if (d->cache_.suggestions(wl, changeNumber(), suggestions))
+		return;
+
 	string utf8word = to_utf8(wl.word());
 
 	vector<string> suggs = m->suggest(utf8word);
@@ -198,6 +207,7 @@ void EnchantChecker::suggest(WordLangTuple const & wl,
 
 	for (; it != suggs.end(); ++it)
 		suggestions.push_back(from_utf8(*it));
+	d->cache_.setSuggestions(wl, changeNumber(), suggestions);
 }
 
 
@@ -59,6 +59,87 @@ MathAlphaSet mathalpha;
 /// The highest code point in UCS4 encoding (1<<20 + 1<<16)
 char_type const max_ucs4 = 0x110000;
 
+/// Maps LaTeX commands to the code points in unicodesymbols that use
+/// them, in ascending order.
+typedef map<docstring, vector<char_type>> CommandIndex;
+/// All math resp. text commands of all symbols
+CommandIndex mathCommandIndex;
+CommandIndex textCommandIndex;
+/// Only the main (i.e. first) command of the symbols that are not deprecated
+CommandIndex mainMathCommandIndex;
+CommandIndex mainTextCommandIndex;
+
+/// Direct-mapped table of the entries of unicodesymbols. It is split in
+/// pages of 256 code points, only the pages containing symbols are filled.
+vector<vector<CharInfo const *>> charInfoTable;
+
+
+void addToIndex(CommandIndex & index, docstring const & cmd, char_type c)
+{
+	vector<char_type> & chars = index[cmd];
+	if (chars.empty() || chars.back() != c)
+		chars.push_back(c);
+}
+
+
+/// Has to be called whenever unicodesymbols changes
+void buildCharInfoIndex()
+{
+	mathCommandIndex.clear();
+	textCommandIndex.clear();
+	mainMathCommandIndex.clear();
+	mainTextCommandIndex.clear();
+	charInfoTable.clear();
+	for (auto const & sym : unicodesymbols) {
+		CharInfo const & info = sym.second;
+		for (docstring const & cmd : info.mathCommands())
+			addToIndex(mathCommandIndex, cmd, sym.first);
+		for (docstring const & cmd : info.textCommands())
+			addToIndex(textCommandIndex, cmd, sym.first);
+		if (!info.deprecated()) {
+			if (!info.mathCommand().empty())
+				addToIndex(mainMathCommandIndex, info.mathCommand(), sym.first);
+			if (!info.textCommand().empty())
+				addToIndex(mainTextCommandIndex, info.textCommand(), sym.first);
+		}
+		size_t const page = sym.first >> 8;
+		if (page >= charInfoTable.size())
+			charInfoTable.resize(page + 1);
+		if (charInfoTable[page].empty())
+			charInfoTable[page].resize(256, nullptr);
+		charInfoTable[page][sym.first & 0xff] = &info;
+	}
+}
+
+
+CharInfo const * lookupCharInfo(char_type c)
+{
+	size_t const page = c >> 8;
+	if (page >= charInfoTable.size() || charInfoTable[page].empty())
+		return nullptr;
+	return charInfoTable[page][c & 0xff];
+}
+
+
+/// Get the symbols that use \p cmd, in ascending order
+vector<char_type> const & symbolsForCommand(CommandIndex const & index,
+                                            docstring const & cmd)
+{
+	static vector<char_type> const none;
+	CommandIndex::const_iterator const it = index.find(cmd);
+	return it == index.end() ? none : it->second;
+}
+
+
+/// Append the symbols whose command starts with \p prefix to \p chars
+void addSymbolsWithPrefix(CommandIndex const & index, docstring const & prefix,
+                          vector<char_type> & chars)
+{
+	CommandIndex::const_iterator it = index.lower_bound(prefix);
+	for (; it != index.end() && prefixIs(it->first, prefix); ++it)
+		chars.insert(chars.end(), it->second.begin(), it->second.end());
+}
+
 } // namespace
 
 
@@ -337,38 +418,42 @@ bool Encodings::latexMathChar(char_type c, bool mathmode,
 char_type Encodings::fromLaTeXCommand(docstring const & cmd, int cmdtype,
 		bool & combining, bool & needsTermination, set<string> * req)
 {
-	CharInfoMap::const_iterator const end = unicodesymbols.end();
-	CharInfoMap::const_iterator it = unicodesymbols.begin();
-	for (combining = false; it != end; ++it) {
-		if (it->second.deprecated())
-			continue;
-
-		if (cmdtype & MATH_CMD) {
-			for (const docstring& math : it->second.mathCommands()) {
-				if ((cmdtype & MATH_CMD) && math == cmd) {
-					combining = it->second.combining();
-					needsTermination = !it->second.mathNoTermination();
-					if (req && it->second.mathFeature() &&
-					    !it->second.mathPreamble().empty())
-						req->insert(it->second.mathPreamble());
-					return it->first;
-				}
+	combining = false;
+	// The first symbol that is not deprecated and uses cmd. If a symbol
+	// has cmd both as math and text command, the math command wins.
+	CharInfo const * mathinfo = nullptr;
+	char_type mathchar = 0;
+	if (cmdtype & MATH_CMD) {
+		for (char_type c : symbolsForCommand(mathCommandIndex, cmd)) {
+			CharInfo const * info = lookupCharInfo(c);
+			if (!info->deprecated()) {
+				mathinfo = info;
+				mathchar = c;
+				break;
 			}
 		}
-
-		if (cmdtype & TEXT_CMD) {
-			for (const docstring& text : it->second.textCommands()) {
-				if (text == cmd) {
-					combining = it->second.combining();
-					needsTermination = !it->second.textNoTermination();
-					if (req && it->second.textFeature() &&
-					    !it->second.textPreamble().empty())
-						req->insert(it->second.textPreamble());
-					return it->first;
-				}
-			}
+	}
+	if (cmdtype & TEXT_CMD) {
+		for (char_type c : symbolsForCommand(textCommandIndex, cmd)) {
+			if (mathinfo && mathchar <= c)
+				break;
+			CharInfo const * info = lookupCharInfo(c);
+			if (info->deprecated())
+				continue;
+			combining = info->combining();
+			needsTermination = !info->textNoTermination();
+			if (req && info->textFeature() && !info->textPreamble().empty())
+				req->insert(info->textPreamble());
+			return c;
 		}
 	}
+	if (mathinfo) {
+		combining = mathinfo->combining();
+		needsTermination = !mathinfo->mathNoTermination();
+		if (req && mathinfo->mathFeature() && !mathinfo->mathPreamble().empty())
+			req->insert(mathinfo->mathPreamble());
+		return mathchar;
+	}
 	needsTermination = false;
 	return 0;
 }
@@ -383,33 +468,28 @@ docstring Encodings::fromLaTeXCommand(docstring const & cmd, int cmdtype,
 	bool const textmode = cmdtype & TEXT_CMD;
 
 	// Easy case: the command is a complete entry of unicodesymbols.
-	for (const auto & unicodeSymbol : unicodesymbols) {
-		if (mathmode) {
-			for (const auto & command : unicodeSymbol.second.mathCommands()) {
-				if (command == cmd) {
-					docstring value;
-					value += unicodeSymbol.first;
-					needsTermination = !unicodeSymbol.second.mathNoTermination();
-					if (req && unicodeSymbol.second.mathFeature()
-						&& !unicodeSymbol.second.mathPreamble().empty())
-							req->insert(unicodeSymbol.second.mathPreamble());
-					return value;
-				}
-			}
-		}
-		if (textmode) {
-			for (const auto & command : unicodeSymbol.second.textCommands()) {
-				if (command == cmd) {
-					docstring value;
-					value += unicodeSymbol.first;
-					needsTermination = !unicodeSymbol.second.textNoTermination();
-					if (req && unicodeSymbol.second.textFeature()
-						&& !unicodeSymbol.second.textPreamble().empty())
-						req->insert(unicodeSymbol.second.textPreamble());
-					return value;
-				}
-			}
-		}
+	// If a symbol has cmd both as math and text command, the math
+	// command wins.
+	vector<char_type> const & mathchars = mathmode
+		? symbolsForCommand(mathCommandIndex, cmd) : vector<char_type>();
+	vector<char_type> const & textchars = textmode
+		? symbolsForCommand(textCommandIndex, cmd) : vector<char_type>();
+	if (!mathchars.empty()
+	    && (textchars.empty() || mathchars.front() <= textchars.front())) {
+		char_type const c = mathchars.front();
+		CharInfo const * info = lookupCharInfo(c);
+		needsTermination = !info->mathNoTermination();
+		if (req && info->mathFeature() && !info->mathPreamble().empty())
+			req->insert(info->mathPreamble());
+		return docstring(1, c);
+	}
+	if (!textchars.empty()) {
+		char_type const c = textchars.front();
+		CharInfo const * info = lookupCharInfo(c);
+		needsTermination = !info->textNoTermination();
+		if (req && info->textFeature() && !info->textPreamble().empty())
+			req->insert(info->textPreamble());
+		return docstring(1, c);
 	}
 
 	// Otherwise, try to map as many commands as possible, matching prefixes of the command.
@@ -459,14 +539,36 @@ docstring Encodings::fromLaTeXCommand(docstring const & cmd, int cmdtype,
 		// the prefix of some command in the unicodesymbols file
 		docstring subcmd = cmd.substr(i, j - i + 1);
 
-		CharInfoMap::const_iterator it = unicodesymbols.begin();
 		// First part of subcmd which might be a combining character
 		docstring combcmd = (m == j) ? docstring() : cmd.substr(i, m - i + 1);
 		// The combining character of combcmd if it exists
 		CharInfoMap::const_iterator combining = uniend;
 		size_t unicmd_size = 0;
 		char_type c = 0;
-		for (; it != uniend; ++it) {
+		// Only the symbols whose command starts with subcmd or is
+		// combcmd can match, look at these in ascending order.
+		vector<char_type> candidates;
+		if (mathmode) {
+			addSymbolsWithPrefix(mainMathCommandIndex, subcmd, candidates);
+			if (!combcmd.empty()) {
+				vector<char_type> const & comb =
+					symbolsForCommand(mainMathCommandIndex, combcmd);
+				candidates.insert(candidates.end(), comb.begin(), comb.end());
+			}
+		}
+		if (textmode) {
+			addSymbolsWithPrefix(mainTextCommandIndex, subcmd, candidates);
+			if (!combcmd.empty()) {
+				vector<char_type> const & comb =
+					symbolsForCommand(mainTextCommandIndex, combcmd);
+				candidates.insert(candidates.end(), comb.begin(), comb.end());
+			}
+		}
+		sort(candidates.begin(), candidates.end());
+		candidates.erase(unique(candidates.begin(), candidates.end()),
+		                 candidates.end());
+		for (char_type const cand : candidates) {
+			CharInfoMap::const_iterator const it = unicodesymbols.find(cand);
 			if (it->second.deprecated())
 				continue;
 			docstring const math = mathmode ? it->second.mathCommand()
@@ -617,17 +719,15 @@ docstring Encodings::fromLaTeXCommand(docstring const & cmd, int cmdtype,
 CharInfo const & Encodings::unicodeCharInfo(char_type c)
 {
 	static CharInfo empty;
-	CharInfoMap::const_iterator const it = unicodesymbols.find(c);
-	return it != unicodesymbols.end() ? it->second : empty;
+	CharInfo const * info = lookupCharInfo(c);
+	return info ? *info : empty;
 }
 
 
 bool Encodings::isCombiningChar(char_type c)
 {
-	CharInfoMap::const_iterator const it = unicodesymbols.find(c);
-	if (it != unicodesymbols.end())
-		return it->second.combining();
-	return false;
+	CharInfo const * info = lookupCharInfo(c);
+	return info && info->combining();
 }
 
 
@@ -894,6 +994,7 @@ void Encodings::read(FileName const & encfile, FileName const & symbolsfile)
 		if (breakout)
 			break;
 	}
+	buildCharInfoIndex();
 
 	// Now read the encodings
 	enum {
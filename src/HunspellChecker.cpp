@@ -12,6 +12,7 @@
 
 #include "HunspellChecker.h"
 #include "PersonalWordList.h"
+#include "SpellResultCache.h"
 
 #include "LyXRC.h"
 #include "WordLangTuple.h"
@@ -81,6 +82,8 @@ struct HunspellChecker::Private
 	LangPersonalWordList personal_;
 	///
 	std::string user_path_;
+	/// results of previous dictionary lookups
+	SpellResultCache cache_;
 
 	/// the location below system/user directory
 	/// there the aff+dic files lookup will happen
@@ -116,6 +119,7 @@ void HunspellChecker::Private::setUserPath(std::string const & path)
 {
 	if (user_path_ != lyxrc.hunspelldir_path) {
 		cleanCache();
+		cache_.clear();
 		user_path_ = path;
 	}
 }
@@ -356,6 +360,10 @@ SpellChecker::Result HunspellChecker::check(WordLangTuple const & wl,
 			return DOCUMENT_LEARNED_WORD;
 	}
 
+	Result res;
+	if (d->cache_.result(wl, changeNumber(), res))
+		return res;
+
 	Hunspell * h = d->speller(wl.lang());
 	if (!h)
 		return NO_DICTIONARY;
@@ -371,18 +379,21 @@ SpellChecker::Result HunspellChecker::check(WordLangTuple const & wl,
 #else
 	if (h->spell(word_to_check.c_str(), &info))
 #endif
-		return d->learned(wl) ? LEARNED_WORD : WORD_OK;
-
-	if (info & SPELL_COMPOUND) {
-		// FIXME: What to do with that?
-		LYXERR(Debug::GUI, "Hunspell compound word found " << word_to_check);
-	}
-	if (info & SPELL_FORBIDDEN) {
-		// This was removed from personal dictionary
-		LYXERR(Debug::GUI, "Hunspell explicit forbidden word found " << word_to_check);
+		res = d->learned(wl) ? LEARNED_WORD : WORD_OK;
+	else {
+		if (info & SPELL_COMPOUND) {
+			// FIXME: What to do with that?
+			LYXERR(Debug::GUI, "Hunspell compound word found " << word_to_check);
+		}
+		if (info & SPELL_FORBIDDEN) {
+			// This was removed from personal dictionary
+			LYXERR(Debug::GUI, "Hunspell explicit forbidden word found " << word_to_check);
+		}
+		res = UNKNOWN_WORD;
 	}
 
-	return UNKNOWN_WORD;
+	d->cache_.setResult(wl, changeNumber(), res);
+	return res;
 }
 
 
@@ -420,6 +431,8 @@ void HunspellChecker::suggest(WordLangTuple const & wl,
 	docstring_list & suggestions)
 {
 	suggestions.clear();
+	if (d->cache_.suggestions(wl, changeNumber(), suggestions))
+		return;
 	Hunspell * h = d->speller(wl.lang());
 	if (!h)
 		return;
@@ -432,12 +445,12 @@ void HunspellChecker::suggest(WordLangTuple const & wl,
 #else
 	char ** suggestion_list;
 	int const suggestion_number = h->suggest(&suggestion_list, word_to_check.c_str());
-	if (suggestion_number <= 0)
-		return;
-	for (int i = 0; i != suggestion_number; ++i)
+	for (int i = 0; i < suggestion_number; ++i)
 		suggestions.push_back(remap_result(from_iconv_encoding(suggestion_list[i], encoding)));
-	h->free_list(&suggestion_list, suggestion_number);
+	if (suggestion_number > 0)
+		h->free_list(&suggestion_list, suggestion_number);
 #endif
+	d->cache_.setSuggestions(wl, changeNumber(), suggestions);
 }
 
 
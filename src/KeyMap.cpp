@@ -106,10 +106,9 @@ void KeyMap::bind(KeySequence * seq, FuncRequest const & func, unsigned int r)
 	KeyModifier const mod2 = seq->modifiers[r].second;
 
 	// check if key is already there
-	// FIXME perf: Profiling shows that this is responsible of 99% of the
-	// cost of GuiPrefs::applyView()
-	Table::iterator end = table.end();
-	for (Table::iterator it = table.begin(); it != end; ++it) {
+	vector<size_t> const * keys = findKeys(code);
+	for (size_t i = 0; keys && i < keys->size(); ++i) {
+		Table::iterator const it = table.begin() + (*keys)[i];
 		if (code == it->code
 		    && mod1 == it->mod.first
 		    && mod2 == it->mod.second) {
@@ -137,6 +136,7 @@ void KeyMap::bind(KeySequence * seq, FuncRequest const & func, unsigned int r)
 	}
 
 	Table::iterator newone = table.insert(table.end(), Key());
+	key_index[code.key()].push_back(table.size() - 1);
 	newone->code = code;
 	newone->mod = seq->modifiers[r];
 	if (r + 1 == seq->length()) {
@@ -162,7 +162,9 @@ void KeyMap::unbind(KeySequence * seq, FuncRequest const & func, unsigned int r)
 	// check if key is already there
 	Table::iterator end = table.end();
 	Table::iterator remove = end;
-	for (Table::iterator it = table.begin(); it != end; ++it) {
+	vector<size_t> const * keys = findKeys(code);
+	for (size_t i = 0; keys && i < keys->size(); ++i) {
+		Table::iterator const it = table.begin() + (*keys)[i];
 		if (code == it->code
 		    && mod1 == it->mod.first
 		    && mod2 == it->mod.second) {
@@ -181,8 +183,10 @@ void KeyMap::unbind(KeySequence * seq, FuncRequest const & func, unsigned int r)
 			}
 		}
 	}
-	if (remove != end)
+	if (remove != end) {
 		table.erase(remove);
+		rebuildIndex();
+	}
 }
 
 
@@ -196,8 +200,9 @@ FuncRequest KeyMap::getBinding(KeySequence const & seq, unsigned int r)
 	KeyModifier const mod2 = seq.modifiers[r].second;
 
 	// check if key is already there
-	Table::iterator end = table.end();
-	for (Table::iterator it = table.begin(); it != end; ++it) {
+	vector<size_t> const * keys = findKeys(code);
+	for (size_t i = 0; keys && i < keys->size(); ++i) {
+		Table::iterator const it = table.begin() + (*keys)[i];
 		if (code == it->code
 		    && mod1 == it->mod.first
 		    && mod2 == it->mod.second) {
@@ -214,6 +219,22 @@ FuncRequest KeyMap::getBinding(KeySequence const & seq, unsigned int r)
 void KeyMap::clear()
 {
 	table.clear();
+	key_index.clear();
+}
+
+
+void KeyMap::rebuildIndex()
+{
+	key_index.clear();
+	for (size_t i = 0; i != table.size(); ++i)
+		key_index[table[i].code.key()].push_back(i);
+}
+
+
+vector<size_t> const * KeyMap::findKeys(KeySymbol const & code) const
+{
+	KeyIndex::const_iterator const it = key_index.find(code.key());
+	return it == key_index.end() ? nullptr : &it->second;
 }
 
 
@@ -436,8 +457,11 @@ FuncRequest const & KeyMap::lookup(KeySymbol const &key,
 		return FuncRequest::unknown;
 	}
 
-	Table::const_iterator end = table.end();
-	for (Table::const_iterator cit = table.begin(); cit != end; ++cit) {
+	// Only the keys with the same keysym can match. They are checked in
+	// table order, since the modifier masks may differ between them.
+	vector<size_t> const * keys = findKeys(key);
+	for (size_t i = 0; keys && i < keys->size(); ++i) {
+		Table::const_iterator const cit = table.begin() + (*keys)[i];
 		KeyModifier mask = cit->mod.second;
 		KeyModifier check = static_cast<KeyModifier>(mod & ~mask);
 
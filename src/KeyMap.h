@@ -20,6 +20,7 @@
 #include "support/strfwd.h"
 
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 
@@ -192,10 +193,19 @@ private:
 
 	/// is the table empty ?
 	bool empty() const { return table.empty(); }
+	/// rebuild key_index after keys were removed from the table
+	void rebuildIndex();
+	/// \returns the positions in the table of the keys that have the
+	/// same keysym as \p code, or nullptr if there are none.
+	std::vector<size_t> const * findKeys(KeySymbol const & code) const;
 	///
 	typedef std::vector<Key> Table;
 	///
 	Table table;
+	/// Positions in the table of the keys, by keysym and in table order
+	typedef std::unordered_map<int, std::vector<size_t>> KeyIndex;
+	///
+	KeyIndex key_index;
 };
 
 /// Implementation is in LyX.cpp
@@ -188,6 +188,8 @@ void LayoutFileList::reset(LayoutFileIndex const & classname)
 			       tc->isTeXClassAvailable());
 	classmap_[classname] = tmpl;
 	delete tc;
+	// the document classes built from the old file are outdated now
+	clearDocumentClassCache();
 }
 
 
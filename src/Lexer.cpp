@@ -80,6 +80,9 @@ public:
 	bool inputAvailable();
 	///
 	void pushToken(string const &);
+	/// Equivalent to is.get(c), but reads directly from the stream
+	/// buffer. This avoids constructing a sentry for every character.
+	bool get(char & c);
 	/// gz_ is only used to open files, the stream is accessed through is.
 	gz::gzstreambuf gz_;
 
@@ -269,6 +272,22 @@ void Lexer::Pimpl::setCommentChar(char c)
 }
 
 
+inline bool Lexer::Pimpl::get(char & c)
+{
+	if (!is.good()) {
+		is.setstate(ios::failbit);
+		return false;
+	}
+	int const i = is.rdbuf()->sbumpc();
+	if (i == char_traits<char>::eof()) {
+		is.setstate(ios::eofbit | ios::failbit);
+		return false;
+	}
+	c = char_traits<char>::to_char_type(i);
+	return true;
+}
+
+
 bool Lexer::Pimpl::next(bool esc /* = false */)
 {
 	if (!pushTok.empty()) {
@@ -290,7 +309,7 @@ bool Lexer::Pimpl::next(bool esc /* = false */)
 	char cc = 0;
 	status = 0;
 	while (is && !status) {
-		is.get(cc);
+		get(cc);
 		unsigned char c = cc;
 
 		if (c == commentChar) {
@@ -316,12 +335,12 @@ bool Lexer::Pimpl::next(bool esc /* = false */)
 
 				do {
 					bool escaped = false;
-					is.get(cc);
+					get(cc);
 					c = cc;
 					if (c == '\r') continue;
 					if (c == '\\') {
 						// escape the next char
-						is.get(cc);
+						get(cc);
 						c = cc;
 						if (c == '\"' || c == '\\')
 							escaped = true;
@@ -337,7 +356,7 @@ bool Lexer::Pimpl::next(bool esc /* = false */)
 			} else {
 
 				do {
-					is.get(cc);
+					get(cc);
 					c = cc;
 					if (c != '\r')
 						buff.push_back(c);
@@ -369,12 +388,12 @@ bool Lexer::Pimpl::next(bool esc /* = false */)
 			do {
 				if (esc && c == '\\') {
 					// escape the next char
-					is.get(cc);
+					get(cc);
 					c = cc;
 					//escaped = true;
 				}
 				buff.push_back(c);
-				is.get(cc);
+				get(cc);
 				c = cc;
 			} while (c > ' ' && c != ',' && is);
 			status = LEX_TOKEN;
@@ -385,7 +404,7 @@ bool Lexer::Pimpl::next(bool esc /* = false */)
 			// possibility of "\r\n" at the end of
 			// a line.  This will stop LyX choking
 			// when it expected to find a '\n'
-			is.get(cc);
+			get(cc);
 			c = cc;
 		}
 
@@ -434,7 +453,7 @@ bool Lexer::Pimpl::eatLine()
 	unsigned char c = '\0';
 	char cc = 0;
 	while (is && c != '\n') {
-		is.get(cc);
+		get(cc);
 		c = cc;
 		//LYXERR(Debug::LYXLEX, "Lexer::EatLine read char: `" << c << '\'');
 		if (c != '\r' && is)
@@ -476,7 +495,7 @@ bool Lexer::Pimpl::nextToken()
 	while (is && !status) {
 		unsigned char c = 0;
 		char cc = 0;
-		is.get(cc);
+		get(cc);
 		c = cc;
 		if ((c >= ' ' || c == '\t') && is) {
 			buff.clear();
@@ -484,13 +503,13 @@ bool Lexer::Pimpl::nextToken()
 			if (c == '\\') { // first char == '\\'
 				do {
 					buff.push_back(c);
-					is.get(cc);
+					get(cc);
 					c = cc;
 				} while (c > ' ' && c != '\\' && is);
 			} else {
 				do {
 					buff.push_back(c);
-					is.get(cc);
+					get(cc);
 					c = cc;
 				} while ((c >= ' ' || c == '\t') && c != '\\' && is);
 			}
@@ -19,6 +19,7 @@
 
 #include "AppleSpellChecker.h"
 #include "AspellChecker.h"
+#include "Benchmark.h"
 #include "Buffer.h"
 #include "BufferList.h"
 #include "CmdDef.h"
@@ -48,6 +49,7 @@
 
 #include "frontends/alert.h"
 #include "frontends/Application.h"
+#include "frontends/Clipboard.h"
 
 #include "support/ConsoleApplication.h"
 #include "support/convert.h"
@@ -409,6 +411,11 @@ int LyX::exec(int & argc, char * argv[])
 
 void LyX::prepareExit()
 {
+	// Other applications may still ask for the clipboard contents
+	// after we are gone.
+	if (use_gui && pimpl_->application_)
+		theClipboard().renderPending();
+
 	// Clear the clipboard and selection stack:
 	cap::clearCutStack();
 	cap::clearSelection();
@@ -625,15 +632,19 @@ void LyX::execCommands()
 		pimpl_->application_->restoreGuiSession();
 
 	// Execute batch commands if available
-	if (pimpl_->batch_commands.empty())
-		return;
-
 	vector<string>::const_iterator bcit  = pimpl_->batch_commands.begin();
 	vector<string>::const_iterator bcend = pimpl_->batch_commands.end();
 	for (; bcit != bcend; ++bcit) {
 		LYXERR(Debug::INIT, "About to handle -x '" << *bcit << '\'');
 		lyx::dispatch(lyxaction.lookupFunc(*bcit));
 	}
+
+	// lyx-bench: replay the script in the loaded document and quit
+	if (Benchmark * bench = theBenchmark()) {
+		bench->run();
+		bench->report(cout);
+		pimpl_->application_->exit(0);
+	}
 }
 
 
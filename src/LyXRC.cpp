@@ -60,7 +60,7 @@ namespace {
 
 // The format should also be updated in configure.py, and conversion code
 // should be added to prefs2prefs_prefs.py.
-static unsigned int const LYXRC_FILEFORMAT = 36; // rkh: spellcheck_continuously default
+static unsigned int const LYXRC_FILEFORMAT = 37; // undo_memory_limit
 // when adding something to this array keep it sorted!
 LexerKeyword lyxrcTags[] = {
 	{ "\\accept_compound", LyXRC::RC_ACCEPT_COMPOUND },
@@ -197,6 +197,7 @@ LexerKeyword lyxrcTags[] = {
 	{ "\\texinputs_prefix", LyXRC::RC_TEXINPUTS_PREFIX },
 	{ "\\thesaurusdir_path", LyXRC::RC_THESAURUSDIRPATH },
 	{ "\\ui_file", LyXRC::RC_UIFILE },
+	{ "\\undo_memory_limit", LyXRC::RC_UNDO_MEMORY_LIMIT },
 	{ "\\use_converter_cache", LyXRC::RC_USE_CONVERTER_CACHE },
 	{ "\\use_converter_needauth", LyXRC::RC_USE_CONVERTER_NEEDAUTH },
 	{ "\\use_converter_needauth_forbidden", LyXRC::RC_USE_CONVERTER_NEEDAUTH_FORBIDDEN },
@@ -336,6 +337,10 @@ LyXRC::ReturnValues LyXRC::read(Lexer & lexrc, bool check_format)
 				ui_file = os::internal_path(lexrc.getString());
 			break;
 
+		case RC_UNDO_MEMORY_LIMIT:
+			lexrc >> undo_memory_limit;
+			break;
+
 		case RC_AUTORESET_OPTIONS:
 			lexrc >> auto_reset_options;
 			break;
@@ -1283,6 +1288,14 @@ void LyXRC::write(ostream & os, bool ignore_system_lyxrc, string const & name) c
 		if (tag != RC_LAST)
 			break;
 		// fall through
+	case RC_UNDO_MEMORY_LIMIT:
+		if (ignore_system_lyxrc ||
+		    undo_memory_limit != system_lyxrc.undo_memory_limit) {
+			os << "\\undo_memory_limit " << undo_memory_limit << '\n';
+		}
+		if (tag != RC_LAST)
+			break;
+		// fall through
 	case RC_AUTOREGIONDELETE:
 		if (ignore_system_lyxrc ||
 		    auto_region_delete != system_lyxrc.auto_region_delete) {
@@ -3050,6 +3063,7 @@ void actOnUpdatedPrefs(LyXRC const & lyxrc_orig, LyXRC const & lyxrc_new)
 	case LyXRC::RC_TEXINPUTS_PREFIX:
 	case LyXRC::RC_THESAURUSDIRPATH:
 	case LyXRC::RC_UIFILE:
+	case LyXRC::RC_UNDO_MEMORY_LIMIT:
 	case LyXRC::RC_USER_EMAIL:
 	case LyXRC::RC_USER_INITIALS:
 	case LyXRC::RC_USER_NAME:
@@ -3462,6 +3476,10 @@ string const LyXRC::getDescription(LyXRCTags tag)
 		str = _("The UI (user interface) file. Can either specify an absolute path, or LyX will look in its global and local ui/ directories.");
 		break;
 
+	case RC_UNDO_MEMORY_LIMIT:
+		str = _("Maximum memory (in MiB) used by the undo history of each document. The oldest undo steps are dropped when it is exceeded. 0 means no limit.");
+		break;
+
 	case RC_USER_EMAIL:
 		break;
 
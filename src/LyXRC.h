@@ -173,6 +173,7 @@ public:
 		RC_TEXINPUTS_PREFIX,
 		RC_THESAURUSDIRPATH,
 		RC_UIFILE,
+		RC_UNDO_MEMORY_LIMIT,
 		RC_USELASTFILEPOS,
 		RC_USER_EMAIL,
 		RC_USER_INITIALS,
@@ -564,6 +565,8 @@ public:
 	// FIXME: should be caret_width
 	///
 	int cursor_width = 0;
+	/// Memory (in MiB) the undo stack of a document may use; 0 means no limit
+	int undo_memory_limit = 256;
 	/// One of: yes, no, ask
 	std::string close_buffer_with_last_view = "yes";
 	enum BookmarksVisibility {
@@ -205,6 +205,22 @@ public:
 		return result;
 	}
 
+	/// \return the first position in [\p from, \p to) which is part
+	/// of a misspelled range, \p to if there is none.
+	pos_type firstMisspelled(pos_type from, pos_type to) const
+	{
+		pos_type result = to;
+		RangesIterator et = ranges_.end();
+		RangesIterator it = ranges_.begin();
+		for (; it != et; ++it) {
+			if (!SpellChecker::misspelled(it->result())
+			    || it->range().last < from)
+				continue;
+			result = min(result, max(from, it->range().first));
+		}
+		return result;
+	}
+
 	FontSpan const & getRange(pos_type pos) const
 	{
 		/// empty span to indicate mismatch
@@ -1696,25 +1712,39 @@ void Paragraph::write(ostream & os, BufferParams const & bparams,
 	// to to_utf8(), which turn out to be expensive (JMarc)
 	docstring write_buffer;
 
+	// Font and change information is only looked up when the
+	// corresponding run ends, not for every character.
+	FontList::const_iterator fit = d->fontlist_.begin();
+	FontList::const_iterator const fend = d->fontlist_.end();
+	pos_type change_end = 0;
+
 	int column = 0;
 	for (pos_type i = 0; i <= size(); ++i) {
 
-		Change const & change = lookupChange(i);
-		if (change != running_change)
-			flushString(os, write_buffer);
-		Changes::lyxMarkChange(os, bparams, column, running_change, change);
-		running_change = change;
+		if (i >= change_end || i == size()) {
+			Change const & change = lookupChange(i);
+			if (change != running_change)
+				flushString(os, write_buffer);
+			Changes::lyxMarkChange(os, bparams, column, running_change, change);
+			running_change = change;
+			change_end = d->changes_.lookupEnd(i);
+		}
 
 		if (i == size())
 			break;
 
 		// Write font changes
-		Font font2 = getFontSettings(bparams, i);
-		if (font2 != font1) {
-			flushString(os, write_buffer);
-			font2.lyxWriteChanges(font1, os);
-			column = 0;
-			font1 = font2;
+		if (i == 0 || fit == fend || fit->pos() < i) {
+			while (fit != fend && fit->pos() < i)
+				++fit;
+			Font const & font2 = (fit != fend) ? fit->font()
+				: getFontSettings(bparams, i);
+			if (font2 != font1) {
+				flushString(os, write_buffer);
+				font2.lyxWriteChanges(font1, os);
+				column = 0;
+				font1 = font2;
+			}
 		}
 
 		char_type const c = d->text_[i];
@@ -5093,6 +5123,28 @@ void Paragraph::spellCheck() const
 }
 
 
+pos_type Paragraph::skipSpellChecked(pos_type from, pos_type to,
+	int & words) const
+{
+	// the stored results are not usable
+	if (needsSpellCheck())
+		return from;
+	pos_type stop = d->speller_state_.firstMisspelled(from, to);
+	// stop in front of insets, they are checked separately
+	for (auto const & elem : d->insetlist_)
+		if (elem.pos >= from && elem.pos < stop) {
+			stop = elem.pos;
+			break;
+		}
+	// count the words skipped
+	for (pos_type pos = from; pos < stop; ++pos)
+		if (!isWordSeparator(pos)
+		    && (pos == from || isWordSeparator(pos - 1)))
+			++words;
+	return stop;
+}
+
+
 bool Paragraph::isMisspelled(pos_type pos, bool check_boundary) const
 {
 	bool result = SpellChecker::misspelled(d->speller_state_.getState(pos));
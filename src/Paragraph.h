@@ -504,6 +504,13 @@ public:
 	/// remember results until call of requestSpellCheck()
 	void spellCheck() const;
 
+	/// Use the remembered results of spellCheck() to skip the correctly
+	/// spelled text in [\p from, \p to). Stops in front of the first
+	/// misspelled word and in front of insets.
+	/// \p words is increased by the number of words skipped.
+	/// \return the position where the check has to continue.
+	pos_type skipSpellChecked(pos_type from, pos_type to, int & words) const;
+
 	/// query state of spell checker results
 	bool needsSpellCheck() const;
 	/// mark position of text manipulation to inform the spell checker
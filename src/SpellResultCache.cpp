@@ -0,0 +1,177 @@
+/**
+ * \file SpellResultCache.cpp
+ * This file is part of LyX, the document processor.
+ * Licence details can be found in the file COPYING.
+ *
+ * Full author contact details are available in file CREDITS.
+ */
+
+#include <config.h>
+
+#include "SpellResultCache.h"
+
+#include "Language.h"
+#include "WordLangTuple.h"
+
+#include "support/Cache.h"
+#include "support/docstring_list.h"
+#include "support/mutex.h"
+
+#include <QByteArray>
+#include <QHash>
+
+#include <string>
+
+using namespace std;
+
+namespace lyx {
+
+namespace {
+
+struct SpellCacheKey {
+	SpellCacheKey(WordLangTuple const & wl)
+		: word(wl.word()), lang(wl.lang()->lang())
+	{}
+	///
+	bool operator==(SpellCacheKey const & rhs) const
+	{
+		return word == rhs.word && lang == rhs.lang;
+	}
+	///
+	docstring word;
+	///
+	string lang;
+};
+
+
+uint qHash(SpellCacheKey const & key)
+{
+	return ::qHash(QByteArray(reinterpret_cast<char const *>(key.word.data()),
+	                          key.word.size() * sizeof(docstring::value_type)))
+		^ ::qHash(QByteArray(key.lang.data(), key.lang.size()));
+}
+
+
+struct SpellCacheEntry {
+	SpellCacheEntry() : result(SpellChecker::NO_DICTIONARY),
+		has_result(false), has_suggestions(false)
+	{}
+	///
+	SpellChecker::Result result;
+	///
+	bool has_result;
+	///
+	docstring_list suggestions;
+	///
+	bool has_suggestions;
+};
+
+} // namespace
+
+
+struct SpellResultCache::Private
+{
+	Private(int max_cost) : cache_(max_cost), change_number_(0) {}
+
+	/// Drop the cached results if they belong to an older change number.
+	/// Has to be called with the mutex held.
+	void validate(SpellChecker::ChangeNumber cn);
+
+	///
+	Cache<SpellCacheKey, SpellCacheEntry> cache_;
+	///
+	SpellChecker::ChangeNumber change_number_;
+	/// The cache may be consulted concurrently
+	Mutex mutex_;
+};
+
+
+void SpellResultCache::Private::validate(SpellChecker::ChangeNumber cn)
+{
+	if (cn == change_number_)
+		return;
+	cache_.clear();
+	change_number_ = cn;
+}
+
+
+SpellResultCache::SpellResultCache(int max_cost)
+	: d(new Private(max_cost))
+{}
+
+
+SpellResultCache::~SpellResultCache()
+{
+	delete d;
+}
+
+
+bool SpellResultCache::result(WordLangTuple const & wl,
+	SpellChecker::ChangeNumber cn, SpellChecker::Result & res) const
+{
+	Mutex::Locker lock(&d->mutex_);
+	d->validate(cn);
+	SpellCacheEntry const * entry = d->cache_.object_ptr(SpellCacheKey(wl));
+	if (!entry || !entry->has_result)
+		return false;
+	res = entry->result;
+	return true;
+}
+
+
+void SpellResultCache::setResult(WordLangTuple const & wl,
+	SpellChecker::ChangeNumber cn, SpellChecker::Result res)
+{
+	Mutex::Locker lock(&d->mutex_);
+	d->validate(cn);
+	SpellCacheKey const key(wl);
+	if (SpellCacheEntry * entry = d->cache_.object_ptr(key)) {
+		entry->result = res;
+		entry->has_result = true;
+		return;
+	}
+	SpellCacheEntry entry;
+	entry.result = res;
+	entry.has_result = true;
+	d->cache_.insert(key, entry);
+}
+
+
+bool SpellResultCache::suggestions(WordLangTuple const & wl,
+	SpellChecker::ChangeNumber cn, docstring_list & suggestions) const
+{
+	Mutex::Locker lock(&d->mutex_);
+	d->validate(cn);
+	SpellCacheEntry const * entry = d->cache_.object_ptr(SpellCacheKey(wl));
+	if (!entry || !entry->has_suggestions)
+		return false;
+	suggestions = entry->suggestions;
+	return true;
+}
+
+
+void SpellResultCache::setSuggestions(WordLangTuple const & wl,
+	SpellChecker::ChangeNumber cn, docstring_list const & suggestions)
+{
+	Mutex::Locker lock(&d->mutex_);
+	d->validate(cn);
+	SpellCacheKey const key(wl);
+	SpellCacheEntry entry;
+	if (SpellCacheEntry const * old = d->cache_.object_ptr(key))
+		entry = *old;
+	entry.suggestions = suggestions;
+	entry.has_suggestions = true;
+	// Suggestion lists are much larger than a single result,
+	// account for them in the cost.
+	d->cache_.insert(key, entry, 1 + int(suggestions.size()));
+}
+
+
+void SpellResultCache::clear()
+{
+	Mutex::Locker lock(&d->mutex_);
+	d->cache_.clear();
+}
+
+
+} // namespace lyx
@@ -0,0 +1,72 @@
+// -*- C++ -*-
+/**
+ * \file SpellResultCache.h
+ * This file is part of LyX, the document processor.
+ * Licence details can be found in the file COPYING.
+ *
+ * Full author contact details are available in file CREDITS.
+ */
+
+#ifndef SPELL_RESULT_CACHE_H
+#define SPELL_RESULT_CACHE_H
+
+#include "SpellChecker.h"
+
+
+namespace lyx {
+
+class WordLangTuple;
+class docstring_list;
+
+/**
+ * A bounded cache of the results of the spell checker backends, keyed by
+ * word and language.
+ *
+ * The backends consult this cache before querying the dictionaries, so
+ * that checking a long document does not ask the backend again for every
+ * occurrence of a common word. The cache is tied to the change number of
+ * the owning SpellChecker: as soon as the change number advances (a word
+ * was learned, removed or accepted, or the preferences changed) all cached
+ * results are dropped.
+ *
+ * Only the dictionary part of the result must be cached here. Checks that
+ * depend on the document (like the document local word list) have to be
+ * done by the caller.
+ */
+class SpellResultCache {
+public:
+	///
+	explicit SpellResultCache(int max_cost = 20000);
+	///
+	~SpellResultCache();
+
+	/// Get the cached result for \p wl. Returns false if not cached.
+	bool result(WordLangTuple const & wl, SpellChecker::ChangeNumber cn,
+		SpellChecker::Result & res) const;
+	/// Store the result for \p wl
+	void setResult(WordLangTuple const & wl, SpellChecker::ChangeNumber cn,
+		SpellChecker::Result res);
+
+	/// Get the cached suggestions for \p wl. Returns false if not cached.
+	bool suggestions(WordLangTuple const & wl, SpellChecker::ChangeNumber cn,
+		docstring_list & suggestions) const;
+	/// Store the suggestions for \p wl
+	void setSuggestions(WordLangTuple const & wl, SpellChecker::ChangeNumber cn,
+		docstring_list const & suggestions);
+
+	/// Drop all cached results
+	void clear();
+
+private:
+	/// noncopyable
+	SpellResultCache(SpellResultCache const &);
+	void operator=(SpellResultCache const &);
+
+	struct Private;
+	Private * d;
+};
+
+
+} // namespace lyx
+
+#endif // SPELL_RESULT_CACHE_H
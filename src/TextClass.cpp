@@ -27,18 +27,26 @@
 
 #include "frontends/alert.h"
 
+#include "support/checksum.h"
+#include "support/convert.h"
 #include "support/lassert.h"
 #include "support/debug.h"
 #include "support/FileName.h"
+#include "support/FileNameList.h"
 #include "support/filetools.h"
 #include "support/gettext.h"
 #include "support/lstrings.h"
+#include "support/mutex.h"
 #include "support/os.h"
+#include "support/Package.h"
 #include "support/TempFile.h"
 
 #include <algorithm>
 #include <fstream>
+#include <iomanip>
+#include <memory>
 #include <sstream>
+#include <tuple>
 
 #ifdef ERROR
 #undef ERROR
@@ -98,6 +106,114 @@ bool layout2layout(FileName const & filename, FileName const & tempfile,
 }
 
 
+/// The first line of a converted layout file, identifying the original
+string convertedLayoutStamp(FileName const & filename)
+{
+	ostringstream os;
+	os << "# Converted to format " << LAYOUT_FORMAT
+	   << " from " << filename.absFileName()
+	   << ' ' << long(filename.lastModified())
+	   << ' ' << filename.checksum();
+	return os.str();
+}
+
+
+/// Remove the converted files whose original does not exist anymore or
+/// that have been converted to another format.
+void cleanLayoutCache(FileName const & dir)
+{
+	string const prefix = "# Converted to format "
+		+ convert<string>(LAYOUT_FORMAT) + " from ";
+	for (FileName const & converted : dir.dirList("layout")) {
+		string stamp;
+		{
+			ifstream is(converted.toFilesystemEncoding().c_str());
+			getline(is, stamp);
+		}
+		// the file name is followed by the time stamp and the checksum
+		bool valid = prefixIs(stamp, prefix);
+		if (valid) {
+			string orig = stamp.substr(prefix.size());
+			for (int i = 0; i < 2 && valid; ++i) {
+				size_t const pos = orig.rfind(' ');
+				valid = pos != string::npos;
+				if (valid)
+					orig.erase(pos);
+			}
+			valid = valid && FileName(orig).exists();
+		}
+		if (!valid) {
+			LYXERR(Debug::TCLASS, "Removing stale converted layout " << converted);
+			converted.removeFile();
+		}
+	}
+}
+
+
+/// Where the result of converting \p filename with layout2layout.py is
+/// kept in the user directory. Empty if there is no usable user directory.
+/// There is one file per original file, which is overwritten when the
+/// original changes.
+FileName convertedLayoutName(FileName const & filename)
+{
+	if (package().user_support().empty())
+		return FileName();
+	FileName const dir(addName(package().user_support().absFileName(),
+	                           "layoutcache"));
+	if (!dir.exists() && !dir.createDirectory(0700))
+		return FileName();
+	// once per run
+	static bool const cleaned = (cleanLayoutCache(dir), true);
+	(void)cleaned;
+	ostringstream os;
+	os << setw(10) << setfill('0') << checksum(filename.absFileName())
+	   << ".layout";
+	return FileName(addName(dir.absFileName(), os.str()));
+}
+
+
+/// Whether \p converted holds the up-to-date conversion of \p filename
+bool isConvertedLayoutValid(FileName const & converted, FileName const & filename)
+{
+	if (converted.empty() || !converted.isReadableFile())
+		return false;
+	ifstream is(converted.toFilesystemEncoding().c_str());
+	string stamp;
+	return getline(is, stamp) && stamp == convertedLayoutStamp(filename);
+}
+
+
+void storeConvertedLayout(FileName const & filename, FileName const & tempfile,
+                          FileName const & converted)
+{
+	// Write to a temporary file first, so that nobody reads a partly
+	// written file with a valid stamp (e.g. another LyX or tex2lyx).
+	TempFile tmp(converted.onlyPath(), "storeXXXXXX.tmp");
+	tmp.setAutoRemove(false);
+	FileName const storefile = tmp.name();
+	bool success = !storefile.empty();
+	if (success) {
+		ifstream is(tempfile.toFilesystemEncoding().c_str());
+		ofstream os(storefile.toFilesystemEncoding().c_str());
+		success = is && os;
+		if (success) {
+			os << convertedLayoutStamp(filename) << '\n' << is.rdbuf();
+			os.close();
+			success = !os.fail();
+		}
+	}
+	if (success)
+		success = storefile.moveTo(converted);
+	if (!success) {
+		LYXERR(Debug::TCLASS, "Could not store converted layout " << converted);
+		if (!storefile.empty())
+			storefile.removeFile();
+		return;
+	}
+	LYXERR(Debug::TCLASS, "Stored converted layout " << converted);
+}
+
+
 string translateReadType(TextClass::ReadType rt)
 {
 	switch (rt) {
@@ -288,6 +404,13 @@ LexerKeyword textClassTags[] = {
 
 
 bool TextClass::convertLayoutFormat(support::FileName const & filename, ReadType rt)
+{
+	return convertLayoutFormat(filename, rt, FileName());
+}
+
+
+bool TextClass::convertLayoutFormat(support::FileName const & filename, ReadType rt,
+		support::FileName const & converted)
 {
 	LYXERR(Debug::TCLASS, "Converting layout file to " << LAYOUT_FORMAT);
 	TempFile tmp("convertXXXXXX.layout");
@@ -295,6 +418,8 @@ bool TextClass::convertLayoutFormat(support::FileName const & filename, ReadType
 	bool success = layout2layout(filename, tempfile);
 	if (success)
 		success = readWithoutConv(tempfile, rt) == OK;
+	if (success && !converted.empty())
+		storeConvertedLayout(filename, tempfile, converted);
 	return success;
 }
 
@@ -357,7 +482,18 @@ bool TextClass::read(FileName const & filename, ReadType rt)
 	if (retval != FORMAT_MISMATCH)
 		return retval == OK;
 
-	bool const worx = convertLayoutFormat(filename, rt);
+	// Running layout2layout.py is slow, and old layout files are
+	// converted every time they are loaded. Therefore the converted
+	// file is kept until the original one changes.
+	FileName const converted = convertedLayoutName(filename);
+	if (isConvertedLayoutValid(converted, filename)) {
+		LYXERR(Debug::TCLASS, "Using converted layout " << converted);
+		if (readWithoutConv(converted, rt) == OK)
+			return true;
+		LYXERR0("Unable to read converted layout " << converted);
+	}
+
+	bool const worx = convertLayoutFormat(filename, rt, converted);
 	if (!worx)
 		LYXERR0 ("Unable to convert " << filename <<
 			" to format " << LAYOUT_FORMAT);
@@ -1990,6 +2126,88 @@ DocumentClassPtr getDocumentClass(LayoutFile const & baseClass, LayoutModuleList
 }
 
 
+bool DocumentClassKey::operator<(DocumentClassKey const & rhs) const
+{
+	return tie(baseclass, modules, cite_engine, forced_local_layout,
+	           local_layout, internal)
+		< tie(rhs.baseclass, rhs.modules, rhs.cite_engine,
+		      rhs.forced_local_layout, rhs.local_layout, rhs.internal);
+}
+
+
+namespace {
+
+struct CachedDocumentClass {
+	/// the class as it has been built, never handed out
+	DocumentClassConstPtr prototype;
+	/// the buffers' copies of it
+	vector<weak_ptr<DocumentClass>> users;
+	///
+	bool inUse()
+	{
+		users.erase(remove_if(users.begin(), users.end(),
+			[](weak_ptr<DocumentClass> const & p) { return p.expired(); }),
+			users.end());
+		return !users.empty();
+	}
+};
+
+
+typedef map<DocumentClassKey, CachedDocumentClass> DocumentClassCache;
+
+DocumentClassCache & documentClassCache()
+{
+	static DocumentClassCache cache;
+	return cache;
+}
+
+Mutex & documentClassCacheMutex()
+{
+	static Mutex mutex;
+	return mutex;
+}
+
+} // namespace
+
+
+DocumentClassPtr findDocumentClass(DocumentClassKey const & key)
+{
+	Mutex::Locker lock(&documentClassCacheMutex());
+	DocumentClassCache::iterator const it = documentClassCache().find(key);
+	if (it == documentClassCache().end() || !it->second.inUse())
+		return DocumentClassPtr();
+	DocumentClassPtr const dc(new DocumentClass(*it->second.prototype));
+	it->second.users.push_back(dc);
+	return dc;
+}
+
+
+void registerDocumentClass(DocumentClassKey const & key, DocumentClassPtr const & dc)
+{
+	Mutex::Locker lock(&documentClassCacheMutex());
+	DocumentClassCache & cache = documentClassCache();
+	// drop the classes that are not used anymore
+	for (DocumentClassCache::iterator it = cache.begin(); it != cache.end(); ) {
+		if (!it->second.inUse())
+			it = cache.erase(it);
+		else
+			++it;
+	}
+	CachedDocumentClass & entry = cache[key];
+	entry.prototype.reset(new DocumentClass(*dc));
+	entry.users.assign(1, dc);
+	LYXERR(Debug::TCLASS, "Registered document class for " << key.baseclass
+	       << ", " << cache.size() << " classes in use");
+}
+
+
+void clearDocumentClassCache()
+{
+	Mutex::Locker lock(&documentClassCacheMutex());
+	documentClassCache().clear();
+}
+
+
 /////////////////////////////////////////////////////////////////////////
 //
 // DocumentClass
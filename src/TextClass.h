@@ -37,6 +37,7 @@ namespace lyx {
 
 namespace support { class FileName; }
 
+struct DocumentClassKey;
 class FloatList;
 class Layout;
 class LayoutFile;
@@ -384,6 +385,10 @@ private:
 	bool deleteInsetLayout(docstring const &);
 	///
 	bool convertLayoutFormat(support::FileName const &, ReadType);
+	/// Like above, but the converted file is also stored as \p converted
+	/// (unless it is empty).
+	bool convertLayoutFormat(support::FileName const &, ReadType,
+		support::FileName const & converted);
 	/// Reads the layout file without running layout2layout.
 	ReturnValues readWithoutConv(support::FileName const & filename, ReadType rt);
 	/// \return true for success.
@@ -560,11 +565,18 @@ protected:
 	/// Needed in tex2lyx
 	DocumentClass() {}
 private:
+	/// Only used to copy a registered class, see findDocumentClass()
+	DocumentClass(DocumentClass const &) = default;
 	/// The only way to make a DocumentClass is to call this function.
 	friend DocumentClassPtr
 		getDocumentClass(LayoutFile const &, LayoutModuleList const &,
 				 std::string const &,
 				 bool clone, bool internal);
+	///
+	friend DocumentClassPtr findDocumentClass(DocumentClassKey const &);
+	///
+	friend void registerDocumentClass(DocumentClassKey const &,
+	                                  DocumentClassPtr const &);
 };
 
 
@@ -577,6 +589,40 @@ DocumentClassPtr getDocumentClass(LayoutFile const & baseClass,
 			std::string const & cengine = std::string(),
 			bool clone = false, bool internal = false);
 
+
+/// The settings a DocumentClass is built from. Buffers with equal
+/// settings can use copies of the same DocumentClass.
+struct DocumentClassKey {
+	///
+	bool operator<(DocumentClassKey const & rhs) const;
+	/// name of the base class
+	std::string baseclass;
+	///
+	std::vector<std::string> modules;
+	///
+	std::string cite_engine;
+	///
+	docstring forced_local_layout;
+	///
+	docstring local_layout;
+	/// whether the warnings have been suppressed when building the class
+	bool internal = false;
+};
+
+/// Get a copy of the DocumentClass that has been registered for \p key,
+/// or a null pointer if there is none or it is not used by any buffer
+/// anymore. Each buffer gets its own copy, since the layouts added by
+/// DocumentClass::addLayoutIfNeeded() and the counters are per buffer.
+DocumentClassPtr findDocumentClass(DocumentClassKey const & key);
+/// Register \p dc as the DocumentClass built for \p key. A copy of the
+/// class as it is now is kept as long as \p dc or one of the copies
+/// handed out by findDocumentClass() is in use, so \p dc may still be
+/// modified afterwards.
+void registerDocumentClass(DocumentClassKey const & key, DocumentClassPtr const & dc);
+/// Forget all registered classes. This has to be called whenever the
+/// layout files may have changed on disk.
+void clearDocumentClassCache();
+
 /// convert page sides option to text 1 or 2
 std::ostream & operator<<(std::ostream & os, PageSides p);
 
@@ -23,11 +23,14 @@
 #include "Cursor.h"
 #include "CutAndPaste.h"
 #include "ErrorList.h"
+#include "InsetList.h"
+#include "LyXRC.h"
 #include "Paragraph.h"
 #include "ParagraphList.h"
 #include "Text.h"
 
 #include "mathed/InsetMath.h"
+#include "mathed/InsetMathNest.h"
 #include "mathed/MathData.h"
 #include "mathed/MathRow.h"
 
@@ -75,7 +78,7 @@ struct UndoElement
 	            pit_type fro, pit_type en, ParagraphList * pl, MathData * ar,
 	            bool lc, size_t gid) :
 		cur_before(cb), cell(cel), from(fro), end(en),
-		pars(pl), array(ar), bparams(nullptr),
+		pars(pl), array(ar), bparams(nullptr), bytes(0),
 		group_id(gid), time(current_time()), kind(kin), lyx_clean(lc)
 		{}
 	///
@@ -83,6 +86,7 @@ struct UndoElement
 				bool lc, size_t gid) :
 		cur_before(cb), cell(), from(0), end(0),
 		pars(nullptr), array(nullptr), bparams(new BufferParams(bp)),
+		bytes(sizeof(BufferParams)),
 		group_id(gid), time(current_time()), kind(ATOMIC_UNDO), lyx_clean(lc)
 	{}
 	///
@@ -91,7 +95,7 @@ struct UndoElement
 		cell(ue.cell), from(ue.from), end(ue.end),
 		pars(ue.pars), array(ue.array),
 		bparams(ue.bparams ? new BufferParams(*ue.bparams) : nullptr),
-		group_id(ue.group_id), time(current_time()), kind(ue.kind),
+		bytes(ue.bytes), group_id(ue.group_id), time(current_time()), kind(ue.kind),
 		lyx_clean(ue.lyx_clean)
 		{}
 	///
@@ -116,6 +120,8 @@ struct UndoElement
 	MathData * array;
 	/// Only used in case of params undo
 	BufferParams const * bparams;
+	/// estimated memory used by the saved contents
+	size_t bytes;
 	/// the element's group id
 	size_t group_id;
 	/// timestamp
@@ -134,7 +140,7 @@ class UndoElementStack
 {
 public:
 	/// limit is the maximum size of the stack
-	UndoElementStack(size_t limit = 100) { limit_ = limit; }
+	UndoElementStack(size_t limit = 100) : limit_(limit), bytes_(0) {}
 	/// limit is the maximum size of the stack
 	~UndoElementStack() { clear(); }
 
@@ -142,7 +148,10 @@ public:
 	UndoElement & top() { return c_.front(); }
 
 	/// Pop and throw away the top element.
-	void pop() { c_.pop_front(); }
+	void pop() {
+		bytes_ -= c_.front().bytes;
+		c_.pop_front();
+	}
 
 	/// Return true if the stack is empty.
 	bool empty() const { return c_.empty(); }
@@ -154,22 +163,30 @@ public:
 			delete c_[i].pars;
 		}
 		c_.clear();
+		bytes_ = 0;
 	}
 
-	/// Push an item on to the stack, deleting the bottom group on
+	/// Push an item on to the stack, deleting the bottom groups on
 	/// overflow.
 	void push(UndoElement const & v) {
-		// Remove some entries if the limit has been reached.
+		c_.push_front(v);
+		bytes_ += v.bytes;
+		// Remove some entries if the limits have been reached.
 		// However, if the only group on the stack is the one
 		// we are currently populating, do nothing.
-		if (c_.size() >= limit_
-		    && c_.front().group_id != v.group_id) {
+		size_t const byte_limit =
+			size_t(max(lyxrc.undo_memory_limit, 0)) * 1024 * 1024;
+		while ((c_.size() > limit_ || (byte_limit && bytes_ > byte_limit))
+		       && c_.back().group_id != v.group_id) {
 			// remove a whole group at once.
 			const size_t gid = c_.back().group_id;
-			while (!c_.empty() && c_.back().group_id == gid)
+			while (c_.back().group_id == gid) {
+				bytes_ -= c_.back().bytes;
+				delete c_.back().array;
+				delete c_.back().pars;
 				c_.pop_back();
+			}
 		}
-		c_.push_front(v);
 	}
 
 	/// Mark all the elements of the stack as dirty
@@ -183,6 +200,8 @@ private:
 	std::deque<UndoElement> c_;
 	/// The maximum number elements stored.
 	size_t limit_;
+	/// The estimated memory used by the stored elements.
+	size_t bytes_;
 };
 
 
@@ -291,6 +310,50 @@ void Undo::markDirty()
 //
 ///////////////////////////////////////////////////////////////////////
 
+namespace {
+
+size_t memoryUsage(ParagraphList const & pars);
+
+
+/// Rough estimate of the memory used by a copy of \p md
+size_t memoryUsage(MathData const & md)
+{
+	size_t bytes = sizeof(MathData);
+	for (MathAtom const & at : md) {
+		// the inset itself, and whatever it owns beyond that
+		bytes += sizeof(MathAtom) + 64;
+		if (InsetMathNest const * nest = at->asNestInset())
+			for (idx_type i = 0; i < nest->nargs(); ++i)
+				bytes += memoryUsage(nest->cell(i));
+	}
+	return bytes;
+}
+
+
+/// Rough estimate of the memory used by a copy of \p pars
+size_t memoryUsage(ParagraphList const & pars)
+{
+	size_t bytes = 0;
+	for (Paragraph const & par : pars) {
+		// the text, plus the font and change tables
+		bytes += sizeof(Paragraph) + 2 * sizeof(char_type) * par.size();
+		for (auto const & insit : par.insetList()) {
+			Inset const & inset = *insit.inset;
+			bytes += 256;
+			for (int i = 0; Text const * text = inset.getText(i); ++i)
+				bytes += memoryUsage(text->paragraphs());
+			if (inset.asInsetMath())
+				if (InsetMathNest const * nest = inset.asInsetMath()->asNestInset())
+					for (idx_type i = 0; i < nest->nargs(); ++i)
+						bytes += memoryUsage(nest->cell(i));
+		}
+	}
+	return bytes;
+}
+
+} // namespace
+
+
 static bool samePar(StableDocIterator const & i1, StableDocIterator const & i2)
 {
 	StableDocIterator tmpi2 = i2;
@@ -313,6 +376,9 @@ void Undo::Private::doRecordUndo(UndoKind kind,
 	if (first_pit > last_pit)
 		swap(first_pit, last_pit);
 
+	// The paragraphs are about to be changed
+	buffer_.recordParagraphChange(cell, first_pit, cell.lastpit() - last_pit);
+
 	// Undo::ATOMIC are always recorded (no overlapping there).
 	// As nobody wants all removed character appear one by one when undoing,
 	// we want combine 'similar' non-ATOMIC undo recordings to one.
@@ -346,6 +412,7 @@ void Undo::Private::doRecordUndo(UndoKind kind,
 		// simply use the whole cell
 		MathData & ar = cell.cell();
 		undo.array = new MathData(ar.buffer(), ar.begin(), ar.end());
+		undo.bytes = memoryUsage(*undo.array);
 	} else {
 		// some more effort needed here as 'the whole cell' of the
 		// main Text _is_ the whole document.
@@ -358,6 +425,7 @@ void Undo::Private::doRecordUndo(UndoKind kind,
 		ParagraphList::const_iterator last = plist.begin();
 		advance(last, last_pit + 1);
 		undo.pars = new ParagraphList(first, last);
+		undo.bytes = memoryUsage(*undo.pars);
 	}
 
 	// push the undo entry to undo stack
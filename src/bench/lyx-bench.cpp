@@ -0,0 +1,142 @@
+/**
+ * \file lyx-bench.cpp
+ * This file is part of LyX, the document processor.
+ * Licence details can be found in the file COPYING.
+ *
+ * Full author contact details are available in file CREDITS.
+ *
+ * The lyx-bench program: runs LyX without a visible window, replays a
+ * script of LyX functions in the given document and reports the latency
+ * of each function. See development/benchmarks/README.
+ */
+
+#include <config.h>
+
+#include "Benchmark.h"
+#include "LyX.h"
+
+#include "support/convert.h"
+#include "support/debug.h"
+#include "support/FileName.h"
+#include "support/filetools.h"
+#include "support/lstrings.h"
+#include "support/os.h"
+
+#include <QtGlobal>
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+using namespace std;
+using namespace lyx;
+using namespace lyx::support;
+
+
+namespace {
+
+atomic<unsigned long long> allocations(0);
+
+
+unsigned long long allocationCount()
+{
+	return allocations;
+}
+
+
+void usage()
+{
+	cerr << "Usage: lyx-bench -script <file> [-repeat <n>] [LyX options] <document>\n"
+	        "Replays the LyX functions of the script in the document and\n"
+	        "prints the latency percentiles of each function.\n";
+}
+
+} // namespace
+
+
+// Count the memory allocations of the whole program
+void * operator new(size_t size)
+{
+	++allocations;
+	if (void * p = malloc(size ? size : 1))
+		return p;
+	throw bad_alloc();
+}
+
+
+void * operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+
+void operator delete(void * p) noexcept
+{
+	free(p);
+}
+
+
+void operator delete[](void * p) noexcept
+{
+	free(p);
+}
+
+
+void operator delete(void * p, size_t) noexcept
+{
+	free(p);
+}
+
+
+void operator delete[](void * p, size_t) noexcept
+{
+	free(p);
+}
+
+
+int main(int argc, char * argv[])
+{
+	lyxerr.setStream(cerr);
+
+	// Remove our own options, the remaining ones are passed to LyX
+	string script;
+	int repeat = 1;
+	int n = 1;
+	for (int i = 1; i < argc; ++i) {
+		string const arg = argv[i];
+		if ((arg == "-script" || arg == "-repeat") && i + 1 < argc) {
+			string const val = argv[++i];
+			if (arg == "-script")
+				script = val;
+			else if (isStrInt(val))
+				repeat = convert<int>(val);
+			continue;
+		}
+		argv[n++] = argv[i];
+	}
+	argc = n;
+	argv[argc] = nullptr;
+
+	if (script.empty() || repeat < 1) {
+		usage();
+		return 1;
+	}
+
+	// No window is needed, but the frontend is (for the font metrics)
+	if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+		qputenv("QT_QPA_PLATFORM", "offscreen");
+
+	lyx::support::os::init(argc, &argv);
+
+	Benchmark bench(makeAbsPath(script), repeat, allocationCount);
+	if (!bench.read())
+		return 1;
+	setBenchmark(&bench);
+
+	lyx::LyX the_lyx_instance;
+	int const status = the_lyx_instance.exec(argc, argv);
+	setBenchmark(nullptr);
+	return status;
+}
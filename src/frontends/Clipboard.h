@@ -16,6 +16,8 @@
 
 #include "support/strfwd.h"
 
+#include <functional>
+
 namespace lyx {
 
 class Cursor;
@@ -68,21 +70,34 @@ public:
 	virtual docstring const & getFindBuffer() { return find_buffer_; }
 
 	/**
-	 * Fill the system clipboard. The format of \p lyx is as written in
-	 * .lyx files, the format of \p text is plain text.
-	 * We put the clipboard contents in LyX format and plain text into
-	 * the system clipboard if supported, so that it is useful for other
-	 * applications as well as other instances of LyX.
+	 * Produces the clipboard contents in LyX format (as written in .lyx
+	 * files) and in XHTML format.
+	 */
+	typedef std::function<void (std::string & lyx, docstring & html)> Renderer;
+
+	/**
+	 * Fill the system clipboard. The format of \p text is plain text,
+	 * the LyX and XHTML formats are produced by \p render.
+	 * We put the clipboard contents in LyX format, XHTML and plain text
+	 * into the system clipboard if supported, so that it is useful for
+	 * other applications as well as other instances of LyX.
+	 * \p render is only called when one of its formats is requested,
+	 * since producing them is expensive for large selections.
 	 * This should be called when the user requests to cut or copy to
 	 * the clipboard.
 	 */
-	virtual void put(std::string const & lyx, docstring const & html, docstring const & text) = 0;
+	virtual void put(Renderer const & render, docstring const & text) = 0;
 
 	/// Put a general string on the system clipboard (not LyX text)
 	virtual void put(std::string const & text) const = 0;
 
 	virtual void setFindBuffer(docstring const & text) { find_buffer_ = text;}
 
+	/// Produce the formats that were put lazily into the system
+	/// clipboard now. This has to be called before quitting, since
+	/// the clipboard may be asked for them after we are gone.
+	virtual void renderPending() = 0;
+
 	/// Does the clipboard contain text contents?
 	virtual bool hasTextContents(TextType type = AnyTextType) const = 0;
 	/// Does the clipboard contain graphics contents of a certain type?
@@ -83,6 +83,7 @@
 #include "support/linkback/LinkBackProxy.h"
 #endif
 
+#include <map>
 #include <queue>
 #include <tuple>
 
@@ -1069,6 +1070,14 @@ struct GuiApplication::Private
 	/// The result of last dispatch action
 	DispatchResult dispatch_result_;
 
+	/// nesting depth of StatusCacheGuard
+	int status_cache_depth_ = 0;
+	/// The results of getStatus() while the status cache is active.
+	/// Keyed by action, argument and origin of the request.
+	std::map<std::tuple<FuncCode, docstring, int>, FuncStatus> status_cache_;
+	/// number of getStatus() calls while the status cache is active
+	int status_calls_ = 0;
+
 	/// Multiple views container.
 	/**
 	* Warning: This must not be a smart pointer as the destruction of the
@@ -1274,6 +1283,41 @@ docstring Application::mathIcon(docstring const & c)
 
 
 FuncStatus GuiApplication::getStatus(FuncRequest const & cmd) const
+{
+	if (d->status_cache_depth_ == 0)
+		return computeStatus(cmd);
+
+	++d->status_calls_;
+	auto const key = make_tuple(cmd.action(), cmd.argument(), int(cmd.origin()));
+	auto const it = d->status_cache_.find(key);
+	if (it != d->status_cache_.end())
+		return it->second;
+	FuncStatus const status = computeStatus(cmd);
+	d->status_cache_[key] = status;
+	return status;
+}
+
+
+void GuiApplication::beginStatusCache()
+{
+	++d->status_cache_depth_;
+}
+
+
+void GuiApplication::endStatusCache()
+{
+	LASSERT(d->status_cache_depth_ > 0, return);
+	if (--d->status_cache_depth_ > 0)
+		return;
+	LYXERR(Debug::ACTION, "Status cache: " << d->status_calls_
+	       << " getStatus() calls, " << d->status_cache_.size()
+	       << " computed");
+	d->status_cache_.clear();
+	d->status_calls_ = 0;
+}
+
+
+FuncStatus GuiApplication::computeStatus(FuncRequest const & cmd) const
 {
 	FuncStatus status;
 
@@ -87,6 +87,11 @@ public:
 
 	///
 	bool getStatus(FuncRequest const & cmd, FuncStatus & status) const;
+	/// Memoize the results of getStatus() until the matching
+	/// endStatusCache(). Use StatusCacheGuard instead of calling this.
+	void beginStatusCache();
+	///
+	void endStatusCache();
 	///
 	void hideDialogs(std::string const & name, Inset * inset) const;
 	///
@@ -239,6 +244,9 @@ private Q_SLOTS:
 #endif
 
 private:
+	/// the uncached version of getStatus()
+	FuncStatus computeStatus(FuncRequest const & cmd) const;
+
 	///
 	void validateCurrentView();
 	///
@@ -274,6 +282,18 @@ private:
 
 extern GuiApplication * guiApp;
 
+/// While an object of this class exists, the results of
+/// GuiApplication::getStatus() are memoized. Use it around code that
+/// queries the status of many functions without changing anything,
+/// like the update of the toolbars. Objects can be nested.
+class StatusCacheGuard {
+public:
+	///
+	StatusCacheGuard() { guiApp->beginStatusCache(); }
+	///
+	~StatusCacheGuard() { guiApp->endStatusCache(); }
+};
+
 struct IconInfo {
 	/// Absolute path to icon file
 	QString filepath;
@@ -108,6 +108,57 @@ QString const emfMimeType(){ return "image/x-emf"; }
 QString const wmfMimeType(){ return "image/x-wmf"; }
 
 
+void LazyMimeData::render() const
+{
+	if (!render_)
+		return;
+	string lyx;
+	docstring html;
+	render_(lyx, html);
+	render_ = nullptr;
+	LYXERR(Debug::CLIPBOARD, "LazyMimeData::render(`" << lyx << "' `"
+			      << to_utf8(html) << "')");
+	// We don't convert the encoding of lyx since the encoding of the
+	// clipboard contents is specified in the data itself
+	lyx_ = QByteArray(lyx.c_str(), lyx.size());
+	html_ = toqstr(html);
+}
+
+
+QStringList LazyMimeData::formats() const
+{
+	QStringList l = QMimeData::formats();
+	l << lyxMimeType() << QString("text/html");
+	return l;
+}
+
+
+bool LazyMimeData::hasFormat(QString const & mimetype) const
+{
+	return formats().contains(mimetype);
+}
+
+
+#if QT_VERSION < 0x060000
+QVariant LazyMimeData::retrieveData(QString const & mimetype,
+                                    QVariant::Type type) const
+#else
+QVariant LazyMimeData::retrieveData(QString const & mimetype,
+                                    QMetaType type) const
+#endif
+{
+	if (mimetype == lyxMimeType()) {
+		render();
+		return lyx_;
+	}
+	if (mimetype == "text/html") {
+		render();
+		return html_;
+	}
+	return QMimeData::retrieveData(mimetype, type);
+}
+
+
 GuiClipboard::GuiClipboard()
 {
 	connect(qApp->clipboard(), SIGNAL(dataChanged()),
@@ -429,31 +480,32 @@ void GuiClipboard::put(string const & text) const
 }
 
 
-void GuiClipboard::put(string const & lyx, docstring const & html, docstring const & text)
+void GuiClipboard::put(Renderer const & render, docstring const & text)
 {
-	LYXERR(Debug::CLIPBOARD, "GuiClipboard::put(`" << lyx << "' `"
-			      << to_utf8(html) << "' `" << to_utf8(text) << "')");
-	// We don't convert the encoding of lyx since the encoding of the
-	// clipboard contents is specified in the data itself
-	QMimeData * data = new QMimeData;
-	if (!lyx.empty()) {
-		QByteArray const qlyx(lyx.c_str(), lyx.size());
-		data->setData(lyxMimeType(), qlyx);
-		// If the OS has not the concept of clipboard ownership,
-		// we recognize internal data through its checksum.
-		if (!hasInternal())
-			checksum = support::checksum(lyx);
+	LYXERR(Debug::CLIPBOARD, "GuiClipboard::put(`" << to_utf8(text) << "')");
+	LazyMimeData * data = new LazyMimeData(render);
+	// If the OS has not the concept of clipboard ownership,
+	// we recognize internal data through its checksum.
+	if (!hasInternal()) {
+		QByteArray const qlyx = data->data(lyxMimeType());
+		checksum = support::checksum(string(qlyx.data(), qlyx.size()));
 	}
 	// Don't test for text.empty() since we want to be able to clear the
 	// clipboard.
 	QString const qtext = toqstr(text);
 	data->setText(qtext);
-	QString const qhtml = toqstr(html);
-	data->setHtml(qhtml);
+	lazy_data_ = data;
 	qApp->clipboard()->setMimeData(data, QClipboard::Clipboard);
 }
 
 
+void GuiClipboard::renderPending()
+{
+	if (lazy_data_)
+		lazy_data_->render();
+}
+
+
 bool GuiClipboard::hasTextContents(Clipboard::TextType type) const
 {
 	switch (type) {
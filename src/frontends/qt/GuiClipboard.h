@@ -18,6 +18,7 @@
 
 #include <QMimeData>
 #include <QObject>
+#include <QPointer>
 #include <QStringList>
 
 #include <cstdint>
@@ -55,6 +56,47 @@ private:
 };
 
 
+/**
+ *  \class LazyMimeData
+ *
+ *  The mime data we put into the clipboard on copy. The LyX and HTML
+ *  formats are advertised, but only produced when somebody asks for them.
+ */
+class LazyMimeData : public QMimeData
+{
+	Q_OBJECT
+public:
+	///
+	explicit LazyMimeData(Clipboard::Renderer const & render)
+		: render_(render)
+	{}
+
+	/// produce the LyX and HTML formats if not done yet
+	void render() const;
+	///
+	QStringList formats() const override;
+	///
+	bool hasFormat(QString const & mimetype) const override;
+
+protected:
+#if QT_VERSION < 0x060000
+	QVariant retrieveData(QString const & mimetype,
+	                      QVariant::Type type) const override;
+#else
+	QVariant retrieveData(QString const & mimetype,
+	                      QMetaType type) const override;
+#endif
+
+private:
+	/// reset once the formats have been produced
+	mutable Clipboard::Renderer render_;
+	///
+	mutable QByteArray lyx_;
+	///
+	mutable QString html_;
+};
+
+
 /**
  * The Qt version of the Clipboard.
  */
@@ -71,7 +113,7 @@ public:
 	support::FileName getAsGraphics(Cursor const & cur, GraphicsType type) const override;
 	docstring const getAsText(TextType type) const override;
 	void put(std::string const & text) const override;
-	void put(std::string const & lyx, docstring const & html, docstring const & text) override;
+	void put(Renderer const & render, docstring const & text) override;
 	bool hasGraphicsContents(GraphicsType type = AnyGraphicsType) const override;
 	bool hasTextContents(TextType type = AnyTextType) const override;
 	bool isInternal() const override;
@@ -83,6 +125,7 @@ public:
 		Clipboard::GraphicsType & type) const;
 
 	void setFindBuffer(docstring const & text) override;
+	void renderPending() override;
 
 private Q_SLOTS:
 	void on_dataChanged();
@@ -98,6 +141,8 @@ private:
 	CacheMimeData cache_;
 	/// checksum for internal clipboard data (used on Mac)
 	std::uint32_t checksum;
+	/// the data we put into the clipboard, as long as it is there
+	QPointer<LazyMimeData> lazy_data_;
 };
 
 QString const lyxMimeType();
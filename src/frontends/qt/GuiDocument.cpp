@@ -3477,6 +3477,8 @@ void GuiDocument::applyView()
 
 	if (biblioChanged_) {
 		buffer().invalidateBibinfoCache();
+		// The cite engine may have changed, which affects all labels
+		buffer().invalidateCiteLabels();
 		buffer().removeBiblioTempFiles();
 	}
 
@@ -88,6 +88,7 @@
 #include <QCloseEvent>
 #include <QDragEnterEvent>
 #include <QDropEvent>
+#include <QEventLoop>
 #include <QFuture>
 #include <QFutureWatcher>
 #include <QGroupBox>
@@ -480,6 +481,8 @@ public:
 	static Buffer::ExportStatus compileAndDestroy(Buffer const * orig,
 			Buffer * buffer, string const & format);
 	static docstring autosaveAndDestroy(Buffer const * orig, Buffer * buffer);
+	static Buffer::SaveResult saveAndDestroy(Buffer * clone,
+			FileName const & backup);
 
 	template<class T>
 	static Buffer::ExportStatus runAndDestroy(const T& func,
@@ -522,6 +525,8 @@ public:
 
 	///
 	QTimer statusbar_timer_;
+	/// coalesces the toolbar updates
+	QTimer toolbar_update_timer_;
 	/// auto-saving of buffers
 	Timeout autosave_timeout_;
 
@@ -530,6 +535,9 @@ public:
 
 	///
 	QFutureWatcher<docstring> autosave_watcher_;
+	QFutureWatcher<Buffer::SaveResult> save_watcher_;
+	/// the buffer being saved by save_watcher_
+	Buffer * saving_buffer_ = nullptr;
 	QFutureWatcher<Buffer::ExportStatus> processing_thread_watcher_;
 	///
 	string last_export_format;
@@ -581,6 +589,10 @@ GuiView::GuiView(int id)
 	}
 	connect(&d.statusbar_timer_, SIGNAL(timeout()),
 		this, SLOT(clearMessage()));
+	d.toolbar_update_timer_.setSingleShot(true);
+	d.toolbar_update_timer_.setInterval(0);
+	connect(&d.toolbar_update_timer_, SIGNAL(timeout()),
+		this, SLOT(doUpdateToolbars()));
 
 	// We don't want to keep the window in memory if it is closed.
 	setAttribute(Qt::WA_DeleteOnClose, true);
@@ -733,6 +745,8 @@ GuiView::GuiView(int id)
 
 	connect(&d.autosave_watcher_, SIGNAL(finished()), this,
 		SLOT(autoSaveThreadFinished()));
+	connect(&d.save_watcher_, SIGNAL(finished()), this,
+		SLOT(saveThreadFinished()));
 
 	connect(&d.processing_thread_watcher_, SIGNAL(started()), this,
 		SLOT(processingThreadStarted()));
@@ -935,6 +949,27 @@ void GuiView::autoSaveThreadFinished()
 }
 
 
+void GuiView::saveThreadFinished()
+{
+	// waitForSaveThread() may have handled the result already
+	Buffer * buf = d.saving_buffer_;
+	if (!buf)
+		return;
+	d.saving_buffer_ = nullptr;
+
+	Buffer::SaveResult const result = d.save_watcher_.result();
+	buf->saveDone(result);
+	if (result.success) {
+		theSession().lastFiles().add(buf->fileName());
+		theSession().writeFile();
+		message(bformat(_("Document %1$s saved."),
+			makeDisplayPath(buf->absFileName())));
+	} else
+		saveBufferFailed(*buf, FileName());
+	updateToolbars();
+}
+
+
 void GuiView::saveLayout() const
 {
 	QSettings settings;
@@ -1235,6 +1270,8 @@ void GuiView::closeEvent(QCloseEvent * close_event)
 {
 	LYXERR(Debug::DEBUG, "GuiView::closeEvent()");
 
+	waitForSaveThread();
+
 	if (!GuiViewPrivate::busyBuffers.isEmpty()) {
 		Alert::warning(_("Exit LyX"),
 			_("LyX could not be closed because documents are being processed by LyX."));
@@ -1882,6 +1919,16 @@ void GuiView::updateLayoutList()
 
 void GuiView::updateToolbars()
 {
+	if (!d.toolbar_update_timer_.isActive())
+		d.toolbar_update_timer_.start();
+}
+
+
+void GuiView::doUpdateToolbars()
+{
+	// The status of many functions is queried below, and nothing
+	// can change in the meantime.
+	StatusCacheGuard const status_cache;
 	if (d.current_work_area_) {
 		int context = 0;
 		if (d.current_work_area_->bufferView().cursor().inMathed()
@@ -2072,6 +2119,15 @@ docstring GuiView::GuiViewPrivate::autosaveAndDestroy(
 }
 
 
+Buffer::SaveResult GuiView::GuiViewPrivate::saveAndDestroy(
+	Buffer * clone, FileName const & backup)
+{
+	Buffer::SaveResult const result = clone->saveFile(backup);
+	delete clone;
+	return result;
+}
+
+
 void GuiView::autoSave()
 {
 	LYXERR(Debug::INFO, "Running autoSave()");
@@ -3270,6 +3326,9 @@ bool GuiView::saveBuffer(Buffer & b, FileName const & fn)
 	if (workArea(b) && workArea(b)->inDialogMode())
 		return true;
 
+	// Do not write the same file twice at the same time
+	waitForSaveThreads();
+
 	if (fn.empty() && b.isUnnamed())
 		return renameBuffer(b, docstring());
 
@@ -3280,6 +3339,67 @@ bool GuiView::saveBuffer(Buffer & b, FileName const & fn)
 		return true;
 	}
 
+	return saveBufferFailed(b, fn);
+}
+
+
+void GuiView::saveBufferInThread(Buffer & b)
+{
+	if (b.isUnnamed() || (workArea(b) && workArea(b)->inDialogMode())) {
+		saveBuffer(b);
+		return;
+	}
+
+	waitForSaveThreads();
+
+	if (!b.checkSave()) {
+		saveBufferFailed(b, FileName());
+		return;
+	}
+	b.resetAutosaveTimers();
+
+	// The snapshot is written and compressed in the worker thread,
+	// so that editing can go on in the meantime.
+	message(bformat(_("Saving document %1$s..."),
+		makeDisplayPath(b.absFileName())));
+	d.saving_buffer_ = &b;
+	b.markSaveSnapshot();
+	QFuture<Buffer::SaveResult> f = QtConcurrent::run(
+		GuiViewPrivate::saveAndDestroy,
+		b.cloneBufferOnly(), b.saveBackupName());
+	d.save_watcher_.setFuture(f);
+}
+
+
+void GuiView::waitForSaveThread()
+{
+	if (!d.saving_buffer_)
+		return;
+	// Do not block the GUI thread with QFuture::waitForFinished(): the
+	// worker may need it, e.g. for a message. The watcher calls
+	// saveThreadFinished() when the save is done.
+	if (!d.save_watcher_.isFinished()) {
+		QEventLoop loop;
+		connect(&d.save_watcher_, SIGNAL(finished()), &loop, SLOT(quit()));
+		if (!d.save_watcher_.isFinished())
+			loop.exec(QEventLoop::ExcludeUserInputEvents);
+	}
+	// The finished() signal may not have been delivered yet
+	saveThreadFinished();
+}
+
+
+void GuiView::waitForSaveThreads()
+{
+	if (!guiApp)
+		return;
+	for (int const id : guiApp->viewIds())
+		guiApp->view(id).waitForSaveThread();
+}
+
+
+bool GuiView::saveBufferFailed(Buffer & b, FileName const & fn)
+{
 	// Switch to this Buffer.
 	setBuffer(&b);
 
@@ -3440,6 +3560,8 @@ bool GuiView::closeWorkArea(GuiWorkArea * wa, bool close_buffer)
 
 	Buffer & buf = wa->bufferView().buffer();
 
+	waitForSaveThreads();
+
 	if (GuiViewPrivate::busyBuffers.contains(&buf)) {
 		Alert::warning(_("Close document"),
 			_("Document could not be closed because it is being processed by LyX."));
@@ -3676,6 +3798,8 @@ void GuiView::gotoNextOrPreviousBuffer(NextOrPrevious np, bool const move)
 static bool ensureBufferClean(Buffer * buffer)
 {
 	LASSERT(buffer, return false);
+	// A save in a separate thread leaves the buffer dirty until it is done
+	GuiView::waitForSaveThreads();
 	if (buffer->isClean() && !buffer->isUnnamed())
 		return true;
 
@@ -3705,6 +3829,8 @@ static bool ensureBufferClean(Buffer * buffer)
 
 bool GuiView::reloadBuffer(Buffer & buf)
 {
+	// Do not read the file while it is being written
+	waitForSaveThreads();
 	currentBufferView()->cursor().reset();
 	Buffer::ReadStatus status = buf.reload();
 	return status == Buffer::ReadSuccess;
@@ -3714,6 +3840,10 @@ bool GuiView::reloadBuffer(Buffer & buf)
 void GuiView::checkExternallyModifiedBuffers()
 {
 	for (Buffer * buf : theBufferList()) {
+		// The file of a buffer being saved is not in a known state.
+		// This is checked again when the window gets the focus.
+		if (buf->isSaving())
+			continue;
 		if (buf->fileName().exists() && buf->isChecksumModified()) {
 			docstring text = bformat(_("Document \n%1$s\n has been externally modified."
 					" Reload now? Any local changes will be lost."),
@@ -4448,10 +4578,20 @@ void GuiView::dispatch(FuncRequest const & cmd, DispatchResult & dr)
 			dr.setMessage(_("Buffer export reset."));
 			break;
 
-		case LFUN_BUFFER_WRITE:
+		case LFUN_BUFFER_WRITE: {
 			LASSERT(doc_buffer, break);
-			saveBuffer(*doc_buffer);
+			// Only a save requested by the user can go on in the
+			// background: internal callers, command sequences and the
+			// lyx server rely on the buffer being clean afterwards.
+			FuncRequest::Origin const origin = cmd.origin();
+			if (cmd.allowAsync() && (origin == FuncRequest::MENU
+			    || origin == FuncRequest::TOOLBAR
+			    || origin == FuncRequest::KEYBOARD))
+				saveBufferInThread(*doc_buffer);
+			else
+				saveBuffer(*doc_buffer);
 			break;
+		}
 
 		case LFUN_BUFFER_WRITE_AS:
 			LASSERT(doc_buffer, break);
@@ -152,6 +152,9 @@ public:
 
 	/// updates the possible layouts selectable
 	void updateLayoutList();
+	/// Schedule an update of the toolbars. Several requests in a row
+	/// (e.g. while typing) result in a single update once the events
+	/// have been processed.
 	void updateToolbars();
 
 	///
@@ -187,6 +190,10 @@ public:
 	/// check for external change of any opened buffer, mainly for svn usage
 	void checkExternallyModifiedBuffers();
 
+	/// wait until the documents being saved in a separate thread by
+	/// any view have been written.
+	static void waitForSaveThreads();
+
 	/** redraw \c inset in all the BufferViews in which it is currently
 	 *  visible. If successful return a pointer to the owning Buffer.
 	 */
@@ -267,6 +274,7 @@ private Q_SLOTS:
 	void processingThreadStarted();
 	void processingThreadFinished();
 	void autoSaveThreadFinished();
+	void saveThreadFinished();
 
 	/// must be called in GUI thread
 	void doShowDialog(QString const & qname, QString const & qdata,
@@ -279,6 +287,9 @@ private Q_SLOTS:
 	///
 	void toolBarPopup(const QPoint &pos);
 
+	/// update the toolbars now, see updateToolbars()
+	void doUpdateToolbars();
+
 private:
 	/// Open given child document in current buffer directory.
 	void openChildDocument(std::string const & filename);
@@ -442,6 +453,14 @@ private:
 	/// save and rename buffer to fn. If fn is empty, the buffer
 	/// is just saved as the filename it already has.
 	bool saveBuffer(Buffer & b, support::FileName const & fn);
+	/// save the buffer as the filename it already has, writing the
+	/// file in a separate thread when possible.
+	void saveBufferInThread(Buffer & b);
+	/// wait until the document being saved in a separate thread
+	/// has been written.
+	void waitForSaveThread();
+	/// ask the user what to do when saving \p b failed.
+	bool saveBufferFailed(Buffer & b, support::FileName const & fn);
 	/// closes a workarea, if close_buffer is true the buffer will
 	/// also be released, otherwise the buffer will be hidden.
 	bool closeWorkArea(GuiWorkArea * wa, bool close_buffer);
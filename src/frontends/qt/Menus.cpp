@@ -2739,6 +2739,9 @@ void Menus::updateMenu(Menu * qmenu)
 	BufferView * bv = 0;
 	if (qmenu->d->view)
 		bv = qmenu->d->view->currentBufferView();
+	// Nothing changes while the menu is built, so the status of
+	// each function has to be computed only once.
+	StatusCacheGuard const status_cache;
 	d->expand(fromLyxMenu, *qmenu->d->top_level_menu, bv);
 	qmenu->d->populate(qmenu, *qmenu->d->top_level_menu);
 }
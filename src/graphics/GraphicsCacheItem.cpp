@@ -27,10 +27,18 @@
 #include "support/filetools.h"
 #include "support/FileMonitor.h"
 #include "support/lassert.h"
+#include "support/Timeout.h"
 #include "support/unique_ptr.h"
 
 #include "support/TempFile.h"
 
+#include <QRunnable>
+#include <QThreadPool>
+
+#include <chrono>
+#include <future>
+#include <set>
+
 using namespace std;
 using namespace lyx::support;
 
@@ -38,11 +46,41 @@ namespace lyx {
 
 namespace graphics {
 
+namespace {
+
+/// Decodes an image file in a worker thread
+class DecodeTask : public QRunnable
+{
+public:
+	DecodeTask(std::shared_ptr<Image> const & image, FileName const & file)
+		: image_(image), file_(file)
+	{}
+	///
+	void run() override
+	{
+		promise_.set_value(image_->load(file_));
+	}
+	///
+	future<bool> result() { return promise_.get_future(); }
+private:
+	/// nobody else uses the image while it is decoded
+	std::shared_ptr<Image> const image_;
+	///
+	FileName const file_;
+	///
+	promise<bool> promise_;
+};
+
+} // namespace
+
+
 class CacheItem::Impl {
 public:
 
 	///
 	Impl(FileName const & file, FileName const & doc_file);
+	///
+	~Impl();
 
 	void startMonitor();
 
@@ -65,10 +103,22 @@ public:
 	 */
 	void convertToDisplayFormat();
 
-	/** Load the image into memory. This is called either from
-	 *  convertToDisplayFormat() direct or from imageConverted().
+	/** Start loading the image into memory. The file is decoded in a
+	 *  worker thread, imageDecoded() is called when this is done.
+	 *  This is called either from convertToDisplayFormat() direct or
+	 *  from imageConverted().
 	 */
-	bool loadImage();
+	void loadImage();
+
+	/// Called in the GUI thread once the worker thread is done.
+	void imageDecoded(bool success);
+
+	/// Hand the decoded images over to their items.
+	static void pollDecoding();
+	/// The items whose image is being decoded
+	static std::set<Impl *> & decodingItems();
+	/// Drives pollDecoding() while images are being decoded
+	static Timeout & decodingTimer();
 
 	/** Get a notification when the image conversion is done.
 	 *  Connected to a signal on_finish_ which is passed to
@@ -118,6 +168,11 @@ public:
 	///
 	ImageStatus status_;
 
+	/// The image while it is decoded in a worker thread
+	std::shared_ptr<Image> decoding_image_;
+	/// The result of the worker thread
+	future<bool> decoded_;
+
 	/// This signal is emitted when the image loading status changes.
 	signal<void()> statusChanged;
 
@@ -150,7 +205,7 @@ bool CacheItem::tryDisplayFormat() const
 	FileName filename;
 	string from;
 	bool const conversion_needed = pimpl_->tryDisplayFormat(filename, from);
-	bool const success = status() == Loaded && !conversion_needed;
+	bool const success = status() == Loading && !conversion_needed;
 	if (!success)
 		pimpl_->reset();
 	return success;
@@ -214,6 +269,13 @@ CacheItem::Impl::Impl(FileName const & file, FileName const & doc_file)
 {}
 
 
+CacheItem::Impl::~Impl()
+{
+	// A running worker thread owns its own reference to the image
+	decodingItems().erase(this);
+}
+
+
 void CacheItem::Impl::startMonitor()
 {
 	if (monitor_)
@@ -249,6 +311,11 @@ void CacheItem::Impl::reset()
 	if (image_)
 		image_.reset();
 
+	// Forget about a running decoding
+	decodingItems().erase(this);
+	decoding_image_.reset();
+	decoded_ = future<bool>();
+
 	status_ = WaitingToLoad;
 
 	if (converter_)
@@ -290,22 +357,39 @@ void CacheItem::Impl::imageConverted(bool success)
 	// Add the converted file to the file cache
 	ConverterCache::get().add(filename_, to_, file_to_load_);
 
-	setStatus(loadImage() ? Loaded : ErrorLoading);
+	loadImage();
+	statusChanged();
 }
 
 
 // This function gets called from the callback after the image has been
 // converted successfully.
-bool CacheItem::Impl::loadImage()
+void CacheItem::Impl::loadImage()
 {
 	LYXERR(Debug::GRAPHICS, "Loading image.");
 
-	image_.reset(newImage());
+	// Decoding large images takes long, do not block the GUI meanwhile.
+	decoding_image_.reset(newImage());
+	DecodeTask * task = new DecodeTask(decoding_image_, file_to_load_);
+	decoded_ = task->result();
+	QThreadPool::globalInstance()->start(task);
+
+	decodingItems().insert(this);
+	if (!decodingTimer().running())
+		decodingTimer().start();
+	status_ = Loading;
+}
+
 
-	bool success = image_->load(file_to_load_);
+void CacheItem::Impl::imageDecoded(bool success)
+{
 	string const text = success ? "succeeded" : "failed";
 	LYXERR(Debug::GRAPHICS, "Image loading " << text << '.');
 
+	if (success)
+		image_ = decoding_image_;
+	decoding_image_.reset();
+
 	// Clean up after loading.
 	if (zipped_)
 		unzipped_filename_.removeFile();
@@ -313,7 +397,51 @@ bool CacheItem::Impl::loadImage()
 	if (remove_loaded_file_ && unzipped_filename_ != file_to_load_)
 		file_to_load_.removeFile();
 
-	return success;
+	setStatus(success ? Loaded : ErrorLoading);
+}
+
+
+void CacheItem::Impl::pollDecoding()
+{
+	set<Impl *> & items = decodingItems();
+	// imageDecoded() tells the world about the new status, which
+	// may reset or delete any of the items. Start over every time.
+	bool found = true;
+	while (found) {
+		found = false;
+		for (Impl * item : items) {
+			if (item->decoded_.wait_for(chrono::seconds(0))
+			    != future_status::ready)
+				continue;
+			items.erase(item);
+			item->imageDecoded(item->decoded_.get());
+			found = true;
+			break;
+		}
+	}
+	if (!items.empty())
+		decodingTimer().start();
+}
+
+
+set<CacheItem::Impl *> & CacheItem::Impl::decodingItems()
+{
+	// Not destroyed on exit, since items may still be destroyed later
+	static set<Impl *> * items = new set<Impl *>;
+	return *items;
+}
+
+
+Timeout & CacheItem::Impl::decodingTimer()
+{
+	// Not destroyed on exit, since the timer has to go before the
+	// application object
+	static Timeout * timer = [](){
+		Timeout * t = new Timeout(20, Timeout::ONETIME);
+		t->timeout.connect([](){ pollDecoding(); });
+		return t;
+	}();
+	return *timer;
 }
 
 
@@ -402,14 +530,14 @@ bool CacheItem::Impl::tryDisplayFormat(FileName & filename, string & from)
 		// No conversion needed!
 		LYXERR(Debug::GRAPHICS, "\tNo conversion needed (from == to)!");
 		file_to_load_ = filename;
-		status_ = loadImage() ? Loaded : ErrorLoading;
+		loadImage();
 		return false;
 	}
 
 	if (ConverterCache::get().inCache(filename, to_)) {
 		LYXERR(Debug::GRAPHICS, "\tNo conversion needed (file in file cache)!");
 		file_to_load_ = ConverterCache::get().cacheName(filename, to_);
-		status_ = loadImage() ? Loaded : ErrorLoading;
+		loadImage();
 		return false;
 	}
 	return true;
@@ -52,7 +52,10 @@ public:
 	///
 	support::FileName const & filename() const;
 
-	/// Try to load a display format.
+	/** Start loading the image if it can be displayed without any
+	 *  conversion. The image is decoded asynchronously.
+	 *  \returns true if loading was started (status() is Loading).
+	 */
 	bool tryDisplayFormat() const;
 
 	/// It's in the cache. Now start the loading process.
@@ -503,8 +503,8 @@ void Loader::Impl::startLoading()
 		return;
 
 	if (cached_item_->tryDisplayFormat()) {
-		status_ = Loaded;
-		createPixmap();
+		// statusChanged() is called once the image is decoded
+		status_ = cached_item_->status();
 		return;
 	}
 
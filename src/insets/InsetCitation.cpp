@@ -554,7 +554,9 @@ docstring InsetCitation::screenLabel() const
 
 void InsetCitation::updateBuffer(ParIterator const &, UpdateType, bool const /*deleted*/)
 {
-	if (!cache.recalculate && buffer().citeLabelsValid())
+	// Only the citations of changed bibliography entries need new labels
+	if (!cache.recalculate && (buffer().citeLabelsValid()
+	    || buffer().citeLabelsValid(getVectorFromString(getParam("key")))))
 		return;
 	// The label may have changed, so we have to re-create it.
 	docstring const glabel = generateLabel();
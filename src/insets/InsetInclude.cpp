@@ -516,6 +516,21 @@ Buffer * InsetInclude::loadIfNeeded() const
 }
 
 
+FileName InsetInclude::childFileToLoad() const
+{
+	if (buffer().isClone() || child_buffer_ || failedtoload_
+	    || isVerbatim(params()) || isListings(params()))
+		return FileName();
+
+	FileName const included_file = includedFileName(buffer(), params());
+	if (!isLyXFileName(included_file.absFileName())
+	    || theBufferList().getBuffer(included_file)
+	    || !included_file.exists())
+		return FileName();
+	return included_file;
+}
+
+
 bool InsetInclude::checkForRecursiveInclude(
 	Buffer const * cbuf, bool silent) const
 {
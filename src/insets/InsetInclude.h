@@ -28,6 +28,7 @@ class LaTeXFeatures;
 class RenderMonitoredPreview;
 
 namespace support {
+	class FileName;
 	class FileNameList;
 }
 
@@ -48,6 +49,9 @@ public:
 
 	/// \return loaded Buffer or zero if the file loading did not proceed.
 	Buffer * loadIfNeeded() const;
+	/// \return the LyX document that loadIfNeeded() would have to load,
+	/// or an empty name if it is loaded already or cannot be loaded.
+	support::FileName childFileToLoad() const;
 
 	/** Update the cache with all bibfiles in use of the child buffer
 	 *  (including bibfiles of grandchild documents).
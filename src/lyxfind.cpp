@@ -4088,7 +4088,7 @@ docstring stringifyFromCursor(DocIterator const & cur, int len)
 		return res;
 	} else if (cur.inMathed()) {
 		CursorSlice cs = cur.top();
-		MathData md = cs.cell();
+		MathData const & md = cs.cell();
 		MathData::const_iterator it_end =
 				(( len == -1 || cs.pos() + len > int(md.size()))
 				 ? md.end()
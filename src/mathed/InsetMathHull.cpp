@@ -2320,11 +2320,22 @@ void InsetMathHull::write(ostream & os) const
 }
 
 
+void InsetMathHull::takeOver(InsetMathHull & other)
+{
+	// Move the cells over instead of cloning every atom of the
+	// (possibly huge) freshly parsed formula.
+	cells_type cells;
+	cells.swap(other.cells_);
+	operator=(other);
+	cells_.swap(cells);
+}
+
+
 void InsetMathHull::read(Lexer & lex)
 {
 	MathAtom at;
 	mathed_parse_normal(buffer_, at, lex, Parse::TRACKMACRO);
-	operator=(*at->asHullInset());
+	takeOver(*at.nucleus()->asHullInset());
 }
 
 
@@ -2333,7 +2344,7 @@ bool InsetMathHull::readQuiet(Lexer & lex)
 	MathAtom at;
 	bool success = mathed_parse_normal(buffer_, at, lex, Parse::QUIET);
 	if (success)
-		operator=(*at->asHullInset());
+		takeOver(*at.nucleus()->asHullInset());
 	return success;
 }
 
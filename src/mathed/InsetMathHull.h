@@ -207,6 +207,8 @@ protected:
 
 private:
 	Inset * clone() const override;
+	/// Like operator=, but moves the cells out of \p other
+	void takeOver(InsetMathHull & other);
 	/// Prepare the preview if preview is enabled.
 	/// \param forexport: whether this is intended for export
 	/// If so, we ignore LyXRC and wait for the image to be generated.
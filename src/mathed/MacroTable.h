@@ -90,6 +90,9 @@ public:
 
 	/// output as TeX macro, only works for lazy MacroData!!!
 	int write(odocstream & os, bool overwriteRedefinition) const;
+	/// read the macro template again on next access,
+	/// only works for lazy MacroData!!!
+	void requery() const { queried_ = pos_.empty(); }
 
 	///
 	bool operator==(MacroData const & x) const {
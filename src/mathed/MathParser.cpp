@@ -601,12 +601,14 @@ void Parser::tokenize(istream & is)
 {
 	// eat everything up to the next \end_inset or end of stream
 	// and store it in s for further tokenization
+	static string const end_inset = "\\end_inset";
 	string s;
 	char c;
 	while (is.get(c)) {
 		s += c;
-		if (s.size() >= 10 && s.substr(s.size() - 10) == "\\end_inset") {
-			s = s.substr(0, s.size() - 10);
+		if (c == 't' && s.size() >= end_inset.size()
+		    && s.compare(s.size() - end_inset.size(), end_inset.size(), end_inset) == 0) {
+			s.resize(s.size() - end_inset.size());
 			break;
 		}
 	}
@@ -527,6 +527,13 @@ time_t FileName::lastModified() const
 }
 
 
+long long FileName::fileSize() const
+{
+	d->refresh();
+	return d->fi.size();
+}
+
+
 bool FileName::chdir() const
 {
 	return QDir::setCurrent(d->fi.absoluteFilePath());
@@ -103,6 +103,8 @@ public:
 	bool isFileEmpty() const;
 	/// returns time of last write access
 	std::time_t lastModified() const;
+	/// returns the size of the file in bytes
+	long long fileSize() const;
 	/// generates a checksum of a file
 	virtual unsigned long checksum() const;
 	/// return true when file is readable but not writable
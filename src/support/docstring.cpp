@@ -19,6 +19,10 @@
 
 #include <QFile>
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
 //Needed in Ubuntu
 #include <typeinfo>
 #if ! defined(USE_WCHAR_T) && defined(__GNUC__)
@@ -69,15 +73,143 @@ string const to_ascii(docstring const & ucs4)
 }
 
 
-void utf8_to_ucs4(string const & utf8, docstring & ucs4)
+namespace {
+
+/// Are all 8 bytes starting at \p p ASCII characters?
+inline bool isAsciiWord(char const * p)
 {
-	size_t n = utf8.size();
-	// as utf8 is a multi-byte encoding, there would be at most
-	// n characters:
+	uint64_t w;
+	memcpy(&w, p, sizeof(w));
+	return (w & 0x8080808080808080ULL) == 0;
+}
+
+
+/// Decode \p utf8 directly into \p ucs4.
+/// \return false if \p utf8 is not valid UTF-8 (the contents of \p ucs4
+/// are unspecified then).
+bool decodeUtf8(string const & utf8, docstring & ucs4)
+{
+	size_t const n = utf8.size();
+	// as utf8 is a multi-byte encoding, there are at most n characters
 	ucs4.resize(n);
-	if (n == 0)
+	char const * const data = utf8.data();
+	unsigned char const * const in =
+		reinterpret_cast<unsigned char const *>(data);
+	char_type * const begin = &ucs4[0];
+	char_type * out = begin;
+	size_t i = 0;
+	while (i < n) {
+		// Most of the text is ASCII, check it a word at a time
+		while (i + 8 <= n && isAsciiWord(data + i)) {
+			for (size_t k = 0; k < 8; ++k)
+				out[k] = in[i + k];
+			out += 8;
+			i += 8;
+		}
+		if (i == n)
+			break;
+		unsigned char const c = in[i];
+		if (c < 0x80) {
+			*out++ = c;
+			++i;
+			continue;
+		}
+		size_t len;
+		char_type cp;
+		char_type min;
+		if ((c & 0xe0) == 0xc0) {
+			len = 2;
+			cp = c & 0x1f;
+			min = 0x80;
+		} else if ((c & 0xf0) == 0xe0) {
+			len = 3;
+			cp = c & 0x0f;
+			min = 0x800;
+		} else if ((c & 0xf8) == 0xf0) {
+			len = 4;
+			cp = c & 0x07;
+			min = 0x10000;
+		} else
+			return false;
+		if (n - i < len)
+			return false;
+		for (size_t k = 1; k < len; ++k) {
+			unsigned char const cc = in[i + k];
+			if ((cc & 0xc0) != 0x80)
+				return false;
+			cp = (cp << 6) | (cc & 0x3f);
+		}
+		// reject overlong sequences, surrogates and non-characters
+		// beyond the unicode range, like iconv does
+		if (cp < min || cp > 0x10ffff || (cp >= 0xd800 && cp <= 0xdfff))
+			return false;
+		*out++ = cp;
+		i += len;
+	}
+	ucs4.resize(out - begin);
+	return true;
+}
+
+
+/// Encode \p ucs4 directly into \p utf8.
+/// \return false if \p ucs4 contains invalid code points.
+bool encodeUtf8(docstring const & ucs4, string & utf8)
+{
+	// Compute the exact size first, so that long strings are not
+	// allocated with four times their size.
+	size_t bytes = 0;
+	for (char_type const c : ucs4) {
+		if (c < 0x80)
+			bytes += 1;
+		else if (c < 0x800)
+			bytes += 2;
+		else if (c < 0x10000) {
+			if (c >= 0xd800 && c <= 0xdfff)
+				return false;
+			bytes += 3;
+		} else if (c <= 0x10ffff)
+			bytes += 4;
+		else
+			return false;
+	}
+	utf8.resize(bytes);
+	if (bytes == ucs4.size()) {
+		// plain ASCII
+		copy(ucs4.begin(), ucs4.end(), utf8.begin());
+		return true;
+	}
+	char * out = &utf8[0];
+	for (char_type const c : ucs4) {
+		if (c < 0x80)
+			*out++ = char(c);
+		else if (c < 0x800) {
+			*out++ = char(0xc0 | (c >> 6));
+			*out++ = char(0x80 | (c & 0x3f));
+		} else if (c < 0x10000) {
+			*out++ = char(0xe0 | (c >> 12));
+			*out++ = char(0x80 | ((c >> 6) & 0x3f));
+			*out++ = char(0x80 | (c & 0x3f));
+		} else {
+			*out++ = char(0xf0 | (c >> 18));
+			*out++ = char(0x80 | ((c >> 12) & 0x3f));
+			*out++ = char(0x80 | ((c >> 6) & 0x3f));
+			*out++ = char(0x80 | (c & 0x3f));
+		}
+	}
+	return true;
+}
+
+} // namespace
+
+
+void utf8_to_ucs4(string const & utf8, docstring & ucs4)
+{
+	if (decodeUtf8(utf8, ucs4))
 		return;
 
+	// Invalid input: let iconv handle it, it knows how to complain.
+	size_t n = utf8.size();
+	ucs4.resize(n);
 	int maxoutsize = n * 4;
 	// basic_string::data() is not recognized by some old gcc version
 	// so we use &(ucs4[0]) instead.
@@ -99,8 +231,13 @@ docstring const from_utf8(string const & utf8)
 
 string const to_utf8(docstring const & ucs4)
 {
-	vector<char> const utf8 = ucs4_to_utf8(ucs4.data(), ucs4.size());
-	return string(utf8.begin(), utf8.end());
+	string utf8;
+	if (encodeUtf8(ucs4, utf8))
+		return utf8;
+
+	// Invalid input: let iconv handle it, it knows how to complain.
+	vector<char> const res = ucs4_to_utf8(ucs4.data(), ucs4.size());
+	return string(res.begin(), res.end());
 }
 
 
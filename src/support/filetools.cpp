@@ -1146,12 +1146,16 @@ cmd_ret const runCommand(string const & cmd)
 	CloseHandle(process.hProcess);
 	if (fclose(inf) != 0)
 		valid = false;
+	bool const exit_ok = valid;
 #elif defined (HAVE_PCLOSE)
 	int const pret = pclose(inf);
 	bool const valid = (pret != -1);
+	// pret is the wait status of the command
+	bool const exit_ok = (pret == 0);
 #elif defined (HAVE__PCLOSE)
 	int const pret = _pclose(inf);
 	bool const valid = (pret != -1);
+	bool const exit_ok = (pret == 0);
 #else
 #error No pclose() function.
 #endif
@@ -1159,7 +1163,7 @@ cmd_ret const runCommand(string const & cmd)
 	if (!valid)
 		perror("RunCommand: could not terminate child process");
 
-	return { valid, result };
+	return { valid, result, exit_ok };
 }
 
 
@@ -335,8 +335,12 @@ bool prefs2prefs(FileName const & filename, FileName const & tempfile,
 bool configFileNeedsUpdate(std::string const & file);
 
 struct cmd_ret {
+	/// could the command be run?
 	bool valid;
+	/// its output
 	std::string result;
+	/// did it exit with status 0?
+	bool success;
 };
 
 cmd_ret const runCommand(std::string const & cmd);
@@ -46,8 +46,10 @@ namespace GZSTREAM_NAMESPACE {
 
 class gzstreambuf : public std::streambuf {
 private:
-    static const int bufferSize = 47+256;    // size of data buff
-    // totals 512 bytes under g++ for igzstream at the end.
+    // size of data buff: 4 bytes of putback area and 64k of data.
+    // A small buffer means one gzread() call (and one underflow())
+    // every few hundred bytes, which dominates reading large files.
+    static const int bufferSize = 4 + 64 * 1024;
 
     gzFile           file;               // file handle for compressed file
     char             buffer[bufferSize]; // data buffer
@@ -0,0 +1,108 @@
+#include <config.h>
+
+#include "../docstring.h"
+
+#include <iomanip>
+#include <iostream>
+
+
+using namespace lyx;
+
+using namespace std;
+
+void print(docstring const & s)
+{
+	cout << s.length() << ':' << hex;
+	for (char_type const c : s)
+		cout << ' ' << static_cast<unsigned long>(c);
+	cout << dec << endl;
+}
+
+
+void print(string const & s)
+{
+	cout << s.length() << ':' << hex;
+	for (char const c : s)
+		cout << ' ' << static_cast<unsigned int>(static_cast<unsigned char>(c));
+	cout << dec << endl;
+}
+
+
+void test_from_utf8()
+{
+	string const input[] = {
+		"",
+		"a",
+		"ASCII only",
+		// longer than one word, with a tail
+		"0123456789abcdefghijklmnopqrstuvwxyz",
+		// two, three and four byte sequences
+		"\xc3\xa4\xc3\xb6\xc3\xbc",
+		"\xe2\x82\xac",
+		"\xf0\x9d\x94\xb8",
+		// multibyte characters in the middle of ASCII words
+		"abcdefg\xc3\x9fhijklmnop\xe2\x82\xacqrstuvw\xf0\x9f\x98\x80xyz",
+		// the boundaries of each sequence length
+		"\x7f\xc2\x80\xdf\xbf\xe0\xa0\x80\xef\xbf\xbf\xf0\x90\x80\x80\xf4\x8f\xbf\xbf"
+	};
+	size_t const n = sizeof(input) / sizeof(input[0]);
+	for (size_t i = 0; i < n; ++i) {
+		docstring const s = from_utf8(input[i]);
+		print(s);
+		// round trip
+		cout << (to_utf8(s) == input[i]) << endl;
+	}
+}
+
+
+void test_from_utf8_invalid()
+{
+	// None of these is valid UTF-8, the conversion has to fail
+	string const input[] = {
+		// truncated sequences
+		"abc\xc3",
+		"abc\xe2\x82",
+		"abcdefgh\xf0\x9d\x94",
+		// stray continuation byte
+		"abc\x80xyz",
+		// bytes which never occur in UTF-8
+		"\xfe\xff",
+		// overlong encoding of '/'
+		"\xc0\xaf",
+		"\xe0\x80\xaf",
+		// encoded surrogate
+		"\xed\xa0\x80"
+	};
+	size_t const n = sizeof(input) / sizeof(input[0]);
+	for (size_t i = 0; i < n; ++i)
+		cout << from_utf8(input[i]).empty() << endl;
+}
+
+
+void test_to_utf8()
+{
+	docstring const input[] = {
+		docstring(),
+		from_ascii("ASCII only"),
+		docstring(1, 0xe4),
+		docstring(1, 0x20ac),
+		docstring(1, 0x1f600),
+		docstring(1, 0x10ffff),
+		from_ascii("abc") + docstring(1, 0x3b1) + from_ascii("def")
+	};
+	size_t const n = sizeof(input) / sizeof(input[0]);
+	for (size_t i = 0; i < n; ++i) {
+		string const s = to_utf8(input[i]);
+		print(s);
+		// round trip
+		cout << (from_utf8(s) == input[i]) << endl;
+	}
+}
+
+
+int main()
+{
+	test_from_utf8();
+	test_from_utf8_invalid();
+	test_to_utf8();
+}
@@ -28,6 +28,7 @@
 #include "support/lstrings.h"
 #include "support/textutils.h"
 
+#include <algorithm>
 #include <atomic>
 #include <map>
 #include <functional>
@@ -40,30 +41,83 @@ namespace lyx {
 namespace xml {
 
 
+namespace {
+
+/// Characters below 64 that may have to be escaped: & - < >
+unsigned long long const special_chars =
+	(1ULL << '&') | (1ULL << '-') | (1ULL << '<') | (1ULL << '>');
+
+
+/// \returns the entity replacing \p s[i], or nullptr if it is kept.
+docstring const * entity(char_type const * s, size_t i,
+                         XMLStream::EscapeSettings e)
+{
+	static docstring const lt = from_ascii("&lt;");
+	static docstring const gt = from_ascii("&gt;");
+	static docstring const amp = from_ascii("&amp;");
+	static docstring const dash = from_ascii("&#45;");
+
+	switch (s[i]) {
+	case '&':
+		return e == XMLStream::ESCAPE_AND || e == XMLStream::ESCAPE_ALL
+			? &amp : nullptr;
+	case '<':
+		return e == XMLStream::ESCAPE_ALL ? &lt : nullptr;
+	case '>':
+		return e == XMLStream::ESCAPE_ALL ? &gt : nullptr;
+	case '-':
+		return e == XMLStream::ESCAPE_COMMENTS && i > 0 && s[i - 1] == '-'
+			? &dash : nullptr;
+	}
+	return nullptr;
+}
+
+
+/// Escapes the \p n characters at \p s. Runs of characters that are kept
+/// are passed as a whole to \p append.
+template<typename Append>
+void escapeRuns(char_type const * s, size_t n, XMLStream::EscapeSettings e,
+                Append append)
+{
+	if (e == XMLStream::ESCAPE_NONE) {
+		append(s, n);
+		return;
+	}
+	size_t start = 0;
+	for (size_t i = 0; i != n; ++i) {
+		char_type const c = s[i];
+		if (c >= 64 || !((special_chars >> c) & 1))
+			continue;
+		docstring const * ent = entity(s, i, e);
+		if (!ent)
+			continue;
+		append(s + start, i - start);
+		append(ent->data(), ent->size());
+		start = i + 1;
+	}
+	append(s + start, n - start);
+}
+
+
+/// Writes the escaped characters directly to the stream
+void writeEscaped(odocstream & os, char_type const * s, size_t n,
+                  XMLStream::EscapeSettings e)
+{
+	escapeRuns(s, n, e, [&os](char_type const * p, size_t len) {
+		if (len)
+			os.write(p, len);
+	});
+}
+
+} // namespace
+
+
 docstring escapeChar(char_type c, XMLStream::EscapeSettings e)
 {
 	docstring str;
-	switch (e) { // For HTML: always ESCAPE_NONE. For XML: it depends, hence the parameter.
-	case XMLStream::ESCAPE_NONE:
-	case XMLStream::ESCAPE_COMMENTS:
-		str += c;
-		break;
-	case XMLStream::ESCAPE_ALL:
-		if (c == '<') {
-			str += "&lt;";
-			break;
-		} else if (c == '>') {
-			str += "&gt;";
-			break;
-		}
-		// fall through
-	case XMLStream::ESCAPE_AND:
-		if (c == '&')
-			str += "&amp;";
-		else
-			str	+=c ;
-		break;
-	}
+	escapeRuns(&c, 1, e, [&str](char_type const * p, size_t len) {
+		str.append(p, len);
+	});
 	return str;
 }
 
@@ -78,15 +132,10 @@ docstring escapeChar(char c, XMLStream::EscapeSettings e)
 docstring escapeString(docstring const & raw, XMLStream::EscapeSettings e)
 {
 	docstring bin;
-	bin.reserve(raw.size() * 2); // crude approximation is sufficient
-	for (size_t i = 0; i != raw.size(); ++i) {
-		char_type c = raw[i];
-		if (e == XMLStream::ESCAPE_COMMENTS && c == '-' && i > 0 && raw[i - 1] == '-')
-			bin += "&#45;";
-		else
-			bin += xml::escapeChar(c, e);
-	}
-
+	bin.reserve(raw.size() + raw.size() / 8); // crude approximation is sufficient
+	escapeRuns(raw.data(), raw.size(), e, [&bin](char_type const * p, size_t len) {
+		bin.append(p, len);
+	});
 	return bin;
 }
 
@@ -216,8 +265,8 @@ bool XMLStream::closeFontTags()
 	// so we've hit a non-font tag.
 	writeError("Tags still open in closeFontTags(). Probably not a problem,\n"
 					   "but you might want to check these tags:");
-	TagDeque::const_reverse_iterator it = tag_stack_.rbegin();
-	TagDeque::const_reverse_iterator const en = tag_stack_.rend();
+	TagStack::const_reverse_iterator it = tag_stack_.rbegin();
+	TagStack::const_reverse_iterator const en = tag_stack_.rend();
 	for (; it != en; ++it) {
 		if (**it == xml::parsep_tag)
 			break;
@@ -296,7 +345,7 @@ XMLStream &XMLStream::operator<<(docstring const &d)
 {
 	is_last_tag_cr_ = false;
 	clearTagDeque();
-	os_ << xml::escapeString(d, escape_);
+	xml::writeEscaped(os_, d.data(), d.size(), escape_);
 	escape_ = ESCAPE_ALL;
 	return *this;
 }
@@ -307,7 +356,7 @@ XMLStream &XMLStream::operator<<(const char *s)
 	is_last_tag_cr_ = false;
 	clearTagDeque();
 	docstring const d = from_ascii(s);
-	os_ << xml::escapeString(d, escape_);
+	xml::writeEscaped(os_, d.data(), d.size(), escape_);
 	escape_ = ESCAPE_ALL;
 	return *this;
 }
@@ -317,7 +366,7 @@ XMLStream &XMLStream::operator<<(char_type c)
 {
 	is_last_tag_cr_ = false;
 	clearTagDeque();
-	os_ << xml::escapeChar(c, escape_);
+	xml::writeEscaped(os_, &c, 1, escape_);
 	escape_ = ESCAPE_ALL;
 	return *this;
 }
@@ -327,7 +376,9 @@ XMLStream &XMLStream::operator<<(char c)
 {
 	is_last_tag_cr_ = false;
 	clearTagDeque();
-	os_ << xml::escapeChar(c, escape_);
+	LATTEST(static_cast<unsigned char>(c) < 0x80);
+	char_type const uc = static_cast<unsigned char>(c);
+	xml::writeEscaped(os_, &uc, 1, escape_);
 	escape_ = ESCAPE_ALL;
 	return *this;
 }
@@ -405,6 +456,11 @@ XMLStream &XMLStream::operator<<(xml::CR const &)
 
 bool XMLStream::isTagOpen(xml::StartTag const &stag, int maxdepth) const
 {
+	// Without a depth limit, start with the most recently opened tags:
+	// these are the ones that are usually closed.
+	if (maxdepth < 0)
+		return find_if(tag_stack_.rbegin(), tag_stack_.rend(),
+			[&stag](TagPtr const & t) { return *t == stag; }) != tag_stack_.rend();
 	auto sit = tag_stack_.begin();
 	auto sen = tag_stack_.cend();
 	for (; sit != sen && maxdepth != 0; ++sit) {
@@ -418,6 +474,9 @@ bool XMLStream::isTagOpen(xml::StartTag const &stag, int maxdepth) const
 
 bool XMLStream::isTagOpen(xml::EndTag const &etag, int maxdepth) const
 {
+	if (maxdepth < 0)
+		return find_if(tag_stack_.rbegin(), tag_stack_.rend(),
+			[&etag](TagPtr const & t) { return etag == *t; }) != tag_stack_.rend();
 	auto sit = tag_stack_.begin();
 	auto sen = tag_stack_.cend();
 	for (; sit != sen && maxdepth != 0; ++sit) {
@@ -531,8 +590,8 @@ XMLStream &XMLStream::operator<<(xml::EndTag const &etag)
 	if (etag.asFontTag()) {
 		// it won't be a problem if the other tags open since this one
 		// are also font tags.
-		TagDeque::const_reverse_iterator rit = tag_stack_.rbegin();
-		TagDeque::const_reverse_iterator ren = tag_stack_.rend();
+		TagStack::const_reverse_iterator rit = tag_stack_.rbegin();
+		TagStack::const_reverse_iterator ren = tag_stack_.rend();
 		for (; rit != ren; ++rit) {
 			if (etag == **rit)
 				break;
@@ -551,7 +610,7 @@ XMLStream &XMLStream::operator<<(xml::EndTag const &etag)
 		// first, we close the intervening tags...
 		TagPtr *curtag = &tag_stack_.back();
 		// ...remembering them in a stack.
-		TagDeque fontstack;
+		TagStack fontstack;
 		while (etag != **curtag) {
 			os_ << (*curtag)->writeEndTag();
 			fontstack.push_back(*curtag);
@@ -17,6 +17,7 @@
 
 #include <deque>
 #include <memory>
+#include <vector>
 
 namespace lyx {
 
@@ -126,13 +127,16 @@ private:
 	// pointers.
 	///
 	typedef std::deque<TagPtr> TagDeque;
+	/// Tags are only pushed and popped at the end of the stack,
+	/// so keep them contiguous.
+	typedef std::vector<TagPtr> TagStack;
 	///
 	template <typename T>
 	TagPtr makeTagPtr(T const & tag) { return std::make_shared<T>(tag); }
 	///
 	TagDeque pending_tags_;
 	///
-	TagDeque tag_stack_;
+	TagStack tag_stack_;
 	///
 	bool is_last_tag_cr_;
 };